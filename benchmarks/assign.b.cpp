@@ -0,0 +1,97 @@
+//Reassignment of sums holding the same case : by assignment of the
+//active value (what `operator=` does) against destroying the value
+//and copying anew (what it did before, and still does when the cases
+//differ)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  struct none_t {};
+
+  template <class T>
+  struct some_t {
+    T value;
+    explicit some_t (T value) : value (std::move (value))
+    {}
+  };
+
+  template <class T>
+  using option = sum_type<some_t<T>, none_t>;
+
+  struct nil_t {};
+
+  //Atoms : a word or a string
+  using atom = sum_type<int, std::string, nil_t>;
+
+  //A payload big enough to be boxed
+  struct point_t {
+    double x, y, z;
+  };
+
+  //Boxed payloads (in the tagged pointer representation)
+  using boxed = sum_type<recursive_wrapper<point_t>, none_t>;
+
+  template <class S>
+  void reconstruct (S& s, S const& t) {
+    s.~S ();
+    new (&s) S (t);
+  }
+
+  //Nanoseconds per assignment of the values of `src` in turn to `dst`
+  //(by assignment or by reconstruction)
+  template <class S>
+  double run (std::vector<S> const& src, bool assign) {
+    std::size_t const ops = 1 << 22;
+    S dst = src.front ();
+    return pgs_bench::ns_per_op ([&]() {
+        for (std::size_t i = 0; i < ops; ++i) {
+          S const& s = src[i % src.size ()];
+          if (assign)
+            dst = s;
+          else
+            reconstruct (dst, s);
+          pgs_bench::escape (dst);
+        }
+      }, ops);
+  }
+
+  template <class S>
+  void report (char const* name, std::vector<S> const& src) {
+    pgs_bench::report (name, "assign", run (src, true));
+    pgs_bench::report (name, "reconstruct", run (src, false));
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  std::vector<option<int>> ints;
+  std::vector<option<std::string>> strings;
+  std::vector<atom> atoms;
+  std::vector<boxed> points;
+  for (int i = 0; i < 64; ++i) {
+    ints.emplace_back (constructor<some_t<int>>{}, i);
+    std::string const str (32 + i % 8, static_cast<char>('a' + i % 26));
+    strings.emplace_back (constructor<some_t<std::string>>{}, str);
+    atoms.emplace_back (constructor<std::string>{}, str);
+    points.emplace_back (
+      constructor<point_t>{}, point_t{double (i), double (i), double (i)});
+  }
+
+  report ("option<int>", ints);
+  report ("option<std::string>", strings);
+  report ("atom (string)", atoms);
+  report ("option<point_t> (boxed)", points);
+
+  return 0;
+}
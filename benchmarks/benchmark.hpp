@@ -0,0 +1,66 @@
+#if !defined (BENCHMARK_4E1B7C2D_9A06_4F38_B5D1_2C7E8F30A946_H)
+#  define BENCHMARK_4E1B7C2D_9A06_4F38_B5D1_2C7E8F30A946_H
+
+//! \file benchmark.hpp
+//!
+//! \brief A minimal timing harness for the benchmarks
+
+#  include <algorithm>
+#  include <chrono>
+#  include <cstddef>
+#  include <cstdio>
+#  include <limits>
+
+namespace pgs_bench {
+
+  //! \brief Keep `t` alive in the eyes of the optimizer
+  template <class T>
+  inline void escape (T const& t) {
+#  if defined (_MSC_VER)
+    static void const* volatile sink;
+    sink = &t;
+#  else
+    asm volatile ("" : : "g"(&t) : "memory");
+#  endif//defined (_MSC_VER)
+  }
+
+  //! \brief The best (over `reps` repetitions) time in nanoseconds
+  //! per operation of `f ()` which performs `ops` operations
+  template <class F>
+  double ns_per_op (F f, std::size_t ops, int reps = 7) {
+    using clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max ();
+    for (int i = 0; i < reps; ++i) {
+      clock::time_point const start = clock::now ();
+      f ();
+      std::chrono::duration<double, std::nano> const t = clock::now () - start;
+      best = std::min (best, t.count () / ops);
+    }
+    return best;
+  }
+
+  //! \brief The best (over `reps` repetitions) time in nanoseconds
+  //! per operation of `f (s)` which performs `ops` operations on the
+  //! state `s` produced by (the untimed) `setup ()`
+  template <class S, class F>
+  double ns_per_op_after (S setup, F f, std::size_t ops, int reps = 7) {
+    using clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max ();
+    for (int i = 0; i < reps; ++i) {
+      auto s = setup ();
+      clock::time_point const start = clock::now ();
+      f (s);
+      std::chrono::duration<double, std::nano> const t = clock::now () - start;
+      best = std::min (best, t.count () / ops);
+    }
+    return best;
+  }
+
+  //! \brief Print a result row
+  inline void report (char const* name, char const* variant, double ns) {
+    std::printf ("%-28s %-22s %10.2f ns/op\n", name, variant, ns);
+  }
+
+}//namespace pgs_bench
+
+#endif //!defined (BENCHMARK_4E1B7C2D_9A06_4F38_B5D1_2C7E8F30A946_H)
@@ -0,0 +1,115 @@
+//Teardown throughput of lists and trees destroyed iteratively (the
+//default) and recursively (`iterative_destruction<>` specialized to
+//`std::false_type`)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <memory>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  //`Iterative` selects the destruction strategy
+  template <bool Iterative> struct cons_t;
+  template <bool Iterative>
+  using list = sum_type<recursive_wrapper<cons_t<Iterative>>, nil_t>;
+
+  template <bool Iterative>
+  struct cons_t {
+    int hd;
+    list<Iterative> tl;
+    cons_t (int hd, list<Iterative> tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+
+  template <bool Iterative>
+  list<Iterative> iota (int n) {
+    list<Iterative> l{constructor<nil_t>{}};
+    for (int i = 0; i < n; ++i)
+      l = list<Iterative>{constructor<cons_t<Iterative>>{}, i, std::move (l)};
+    return l;
+  }
+
+  struct empty_t {};
+
+  template <bool Iterative> struct node_t;
+  template <bool Iterative>
+  using tree = sum_type<empty_t, recursive_wrapper<node_t<Iterative>>>;
+
+  template <bool Iterative>
+  struct node_t {
+    int key;
+    tree<Iterative> left, right;
+    node_t (int key, tree<Iterative> left, tree<Iterative> right)
+      : key {key}, left (std::move (left)), right (std::move (right))
+    {}
+  };
+
+  //A complete tree of the given depth
+  template <bool Iterative>
+  tree<Iterative> complete (int depth) {
+    if (depth == 0)
+      return tree<Iterative>{constructor<empty_t>{}};
+    return tree<Iterative>{constructor<node_t<Iterative>>{}
+      , depth, complete<Iterative> (depth - 1), complete<Iterative> (depth - 1)};
+  }
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct iterative_destruction<cons_t<false>> : std::false_type
+  {};
+
+  template <>
+  struct iterative_destruction<node_t<false>> : std::false_type
+  {};
+
+}//namespace pgs
+
+namespace {
+
+  template <bool Iterative>
+  void run (char const* variant, int length) {
+    using list_ptr = std::unique_ptr<list<Iterative>>;
+    pgs_bench::report ("list: destroy", variant,
+      pgs_bench::ns_per_op_after (
+        [=]() { return list_ptr {new list<Iterative> (iota<Iterative> (length))}; },
+        [](list_ptr& l) { l.reset (); },
+        length));
+
+    int const depth = 16;
+    using tree_ptr = std::unique_ptr<tree<Iterative>>;
+    pgs_bench::report ("tree: destroy", variant,
+      pgs_bench::ns_per_op_after (
+        [=]() { return tree_ptr {new tree<Iterative> (complete<Iterative> (depth))}; },
+        [](tree_ptr& t) { t.reset (); },
+        (1 << depth) - 1));
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  //Short enough for recursion not to overflow the stack
+  int const length = 10000;
+  run<false> ("recursive", length);
+  run<true> ("iterative", length);
+
+  //Only the iterative strategy copes with this
+  int const long_length = 10000000;
+  using list_ptr = std::unique_ptr<list<true>>;
+  pgs_bench::report ("list: destroy (10M)", "iterative",
+    pgs_bench::ns_per_op_after (
+      [=]() { return list_ptr {new list<true> (iota<true> (long_length))}; },
+      [](list_ptr& l) { l.reset (); },
+      long_length, 1));
+
+  return 0;
+}
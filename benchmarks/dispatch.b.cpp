@@ -0,0 +1,91 @@
+//Dispatch on the cases of two sums : by nested `match`es (a dispatch
+//on the first sum then one on the second) against a single `match`
+//on both (one dispatch through a table of every combination of cases)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  template <int K>
+  struct k_t {
+    int n;
+    explicit k_t (int n) : n {n}
+    {}
+  };
+
+  using value = sum_type<k_t<0>, k_t<1>, k_t<2>, k_t<3>>;
+
+  //A binary operation defined on every combination of cases : the
+  //result depends on both cases
+  template <int K>
+  struct inner {
+    int x;
+    template <int L>
+    int operator () (k_t<L> const& y) const {
+      return x * (K + 1) + y.n * L;
+    }
+  };
+
+  struct outer {
+    value const& v;
+    template <int K>
+    int operator () (k_t<K> const& x) const {
+      return v.match<int>(inner<K>{x.n});
+    }
+  };
+
+  int nested (value const& u, value const& v) {
+    return u.match<int>(outer{v});
+  }
+
+  struct both {
+    template <int K, int L>
+    int operator () (k_t<K> const& x, k_t<L> const& y) const {
+      return inner<K>{x.n} (y);
+    }
+  };
+
+  int flat (value const& u, value const& v) {
+    return match<int>(u, v, both{});
+  }
+
+  value make (int i) {
+    switch (i % 4) {
+    case 0: return value{constructor<k_t<0>>{}, i};
+    case 1: return value{constructor<k_t<1>>{}, i};
+    case 2: return value{constructor<k_t<2>>{}, i};
+    default: return value{constructor<k_t<3>>{}, i};
+    }
+  }
+
+  //Nanoseconds per pair of values
+  template <class F>
+  double run (std::vector<value> const& src, F f) {
+    std::size_t const ops = 1 << 22;
+    return pgs_bench::ns_per_op ([&]() {
+        int acc = 0;
+        for (std::size_t i = 0; i < ops; ++i)
+          acc += f (src[i % src.size ()], src[(i * 7 + 3) % src.size ()]);
+        pgs_bench::escape (acc);
+      }, ops);
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  std::vector<value> src;
+  for (int i = 0; i < 1021; ++i)
+    src.push_back (make ((i * 37) % 101));
+
+  pgs_bench::report ("pair of 4 cases", "nested", run (src, nested));
+  pgs_bench::report ("pair of 4 cases", "flat", run (src, flat));
+
+  return 0;
+}
@@ -0,0 +1,110 @@
+//Throughput of `hash_cons<>` with threads interning (and dropping)
+//overlapping sets of nodes, for a sharded intern table (the default)
+//and for a table of one shard (a single lock)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  //`Sharded` selects the intern table
+  template <bool Sharded> struct add_t;
+  template <bool Sharded> struct add_hash;
+
+  template <bool Sharded>
+  using xpr_t = sum_type<int, interned<add_t<Sharded>, add_hash<Sharded>>>;
+
+  template <bool Sharded>
+  struct add_t {
+    xpr_t<Sharded> l, r;
+    add_t (xpr_t<Sharded> l, xpr_t<Sharded> r)
+      : l (std::move (l)), r (std::move (r))
+    {}
+  };
+
+  template <bool Sharded>
+  bool operator== (add_t<Sharded> const& x, add_t<Sharded> const& y) {
+    return x.l == y.l && x.r == y.r;
+  }
+
+  template <bool Sharded>
+  std::size_t shallow_hash (xpr_t<Sharded> const& x) {
+    return x.template match<std::size_t>(
+      [](int i) { return std::hash<int>{}(i); },
+      [](add_t<Sharded> const& a) {
+        return std::hash<add_t<Sharded> const*>{}(&a); });
+  }
+
+  template <bool Sharded>
+  struct add_hash {
+    std::size_t operator () (add_t<Sharded> const& a) const {
+      return shallow_hash<Sharded>(a.l) * 31 + shallow_hash<Sharded>(a.r);
+    }
+  };
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct intern_shards<add_t<false>> : std::integral_constant<std::size_t, 1>
+  {};
+
+}//namespace pgs
+
+namespace {
+
+  template <bool Sharded>
+  xpr_t<Sharded> add (int l, int r) {
+    return xpr_t<Sharded>{constructor<add_t<Sharded>>{}
+      , hash_cons<add_t<Sharded>, add_hash<Sharded>>::make (
+          xpr_t<Sharded>{constructor<int>{}, l}
+        , xpr_t<Sharded>{constructor<int>{}, r})};
+  }
+
+  //Each thread keeps the last 1024 of the nodes it interned alive
+  //(4096 distinct nodes are interned over and over)
+  template <bool Sharded>
+  void work (std::size_t ops) {
+    std::vector<xpr_t<Sharded>> ring (
+      1024, xpr_t<Sharded>{constructor<int>{}, 0});
+    for (std::size_t i = 0; i < ops; ++i)
+      ring[i % 1024] = add<Sharded>(i % 64, i / 64 % 64);
+    pgs_bench::escape (ring);
+  }
+
+  //Nanoseconds per intern (of all threads together)
+  template <bool Sharded>
+  double run (int threads, std::size_t ops) {
+    return pgs_bench::ns_per_op ([=]() {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t)
+          pool.emplace_back (&work<Sharded>, ops / threads);
+        for (std::thread& t : pool)
+          t.join ();
+      }, ops, 3);
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  std::size_t const ops = 1 << 21;
+  for (int threads : {1, 4, 16, 64}) {
+    char name[32];
+    std::snprintf (name, sizeof (name), "intern (%d threads)", threads);
+    pgs_bench::report (name, "1 shard", run<false>(threads, ops));
+    pgs_bench::report (name, "64 shards", run<true>(threads, ops));
+  }
+
+  return 0;
+}
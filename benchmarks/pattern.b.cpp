@@ -0,0 +1,182 @@
+//Rewrite rules on expressions : tried in turn, each testing the cases
+//it needs (the cases tested by several rules are tested again by
+//each), by hand-nested `match`es, and by `match_rules` (one decision
+//tree : each case is tested once)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <cstddef>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  struct E_const;
+  struct E_add;
+  struct E_mul;
+
+  using xpr_t = sum_type<
+      recursive_wrapper<E_const>
+    , recursive_wrapper<E_add>
+    , recursive_wrapper<E_mul>>;
+
+  struct E_const {
+    int i;
+    explicit E_const (int i) : i {i}
+    {}
+  };
+
+  struct E_add {
+    xpr_t l, r;
+    E_add (xpr_t const& l, xpr_t const& r) : l {l}, r {r}
+    {}
+  };
+
+  struct E_mul {
+    xpr_t l, r;
+    E_mul (xpr_t const& l, xpr_t const& r) : l {l}, r {r}
+    {}
+  };
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct pattern_fields<E_add> {
+    static std::tuple<xpr_t const&, xpr_t const&> get (E_add const& e) {
+      return std::tie (e.l, e.r);
+    }
+  };
+
+  template <>
+  struct pattern_fields<E_mul> {
+    static std::tuple<xpr_t const&, xpr_t const&> get (E_mul const& e) {
+      return std::tie (e.l, e.r);
+    }
+  };
+
+}//namespace pgs
+
+namespace {
+
+  xpr_t cst (int i) {
+    return xpr_t{constructor<E_const>{}, i};
+  }
+
+  xpr_t add (xpr_t const& l, xpr_t const& r) {
+    return xpr_t{constructor<E_add>{}, l, r};
+  }
+
+  xpr_t mul (xpr_t const& l, xpr_t const& r) {
+    return xpr_t{constructor<E_mul>{}, l, r};
+  }
+
+  //The value of the rule that applies (a rewrite would build a new
+  //expression : only the selection of the rule is measured)
+  int by_tests (xpr_t const& e) {
+    if (e.is<E_add>()) {
+      E_add const& a = get<E_add>(e);
+      if (a.l.is<E_const>() && a.r.is<E_const>())
+        return get<E_const>(a.l).i + get<E_const>(a.r).i;
+    }
+    if (e.is<E_add>()) {
+      E_add const& a = get<E_add>(e);
+      if (a.l.is<E_const>() && get<E_const>(a.l).i == 0)
+        return 1;
+    }
+    if (e.is<E_mul>()) {
+      E_mul const& m = get<E_mul>(e);
+      if (m.l.is<E_const>() && m.r.is<E_const>())
+        return get<E_const>(m.l).i * get<E_const>(m.r).i;
+    }
+    if (e.is<E_mul>()) {
+      E_mul const& m = get<E_mul>(e);
+      if (m.l.is<E_const>() && get<E_const>(m.l).i == 0)
+        return 0;
+    }
+    return -1;
+  }
+
+  //The same rules as nested `match`es : the operands are matched
+  //again under each case of the root
+  int left_const (xpr_t const& l, int k) {
+    return l.match<int>(
+      [=](E_const const& x) { return x.i == 0 ? k : -1; },
+      [](otherwise) { return -1; });
+  }
+
+  int by_matches (xpr_t const& e) {
+    return e.match<int>(
+      [](E_add const& a) {
+        return match<int>(a.l, a.r,
+          [](E_const const& x, E_const const& y) { return x.i + y.i; },
+          [&](otherwise, otherwise) { return left_const (a.l, 1); });
+      },
+      [](E_mul const& m) {
+        return match<int>(m.l, m.r,
+          [](E_const const& x, E_const const& y) { return x.i * y.i; },
+          [&](otherwise, otherwise) { return left_const (m.l, 0); });
+      },
+      [](otherwise) { return -1; });
+  }
+
+  int by_rules (xpr_t const& e) {
+    return match_rules<int>(e,
+      rule (case_of<E_add>(case_of<E_const>(), case_of<E_const>()),
+        [](E_add const&, E_const const& x, E_const const& y) {
+          return x.i + y.i;
+        }),
+      rule (case_of<E_add>(case_of<E_const>(), var),
+        [](E_add const&, E_const const& x, xpr_t const&) { return x.i == 0; },
+        [](E_add const&, E_const const&, xpr_t const&) { return 1; }),
+      rule (case_of<E_mul>(case_of<E_const>(), case_of<E_const>()),
+        [](E_mul const&, E_const const& x, E_const const& y) {
+          return x.i * y.i;
+        }),
+      rule (case_of<E_mul>(case_of<E_const>(), var),
+        [](E_mul const&, E_const const& x, xpr_t const&) { return x.i == 0; },
+        [](E_mul const&, E_const const&, xpr_t const&) { return 0; }),
+      rule (var, [](xpr_t const&) { return -1; }));
+  }
+
+  //Nanoseconds per expression
+  template <class F>
+  double run (std::vector<xpr_t> const& src, F f) {
+    std::size_t const ops = 1 << 22;
+    return pgs_bench::ns_per_op ([&]() {
+        int acc = 0;
+        for (std::size_t i = 0; i < ops; ++i)
+          acc += f (src[i % src.size ()]);
+        pgs_bench::escape (acc);
+      }, ops);
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  std::vector<xpr_t> src;
+  for (int i = 0; i < 1021; ++i) {
+    xpr_t const k = cst (i % 3);
+    xpr_t const s = add (cst (1), cst (2));
+    switch ((i * 37) % 7) {
+    case 0: src.push_back (add (k, k)); break;
+    case 1: src.push_back (add (k, s)); break;
+    case 2: src.push_back (mul (k, k)); break;
+    case 3: src.push_back (mul (k, s)); break;
+    case 4: src.push_back (add (s, k)); break;
+    case 5: src.push_back (mul (s, s)); break;
+    default: src.push_back (k); break;
+    }
+  }
+
+  pgs_bench::report ("rewrite rules", "tests", run (src, by_tests));
+  pgs_bench::report ("rewrite rules", "matches", run (src, by_matches));
+  pgs_bench::report ("rewrite rules", "match_rules", run (src, by_rules));
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+//Build a search tree by insertions that rebuild the path to the new
+//node : from a `const` tree (the sub-trees off the path and the
+//payloads on it are copied) against from a consumed tree (they are
+//moved, by `match` on an rvalue)
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  struct empty_t {};
+  struct node_t;
+
+  using tree = sum_type<empty_t, recursive_wrapper<node_t>>;
+
+  struct node_t {
+    std::string data;
+    tree left_child, right_child;
+
+    template <class D, class L, class R>
+    node_t (D&& data, L&& left_child, R&& right_child)
+      : data {std::forward<D>(data)}
+      , left_child {std::forward<L>(left_child)}
+      , right_child {std::forward<R>(right_child)}
+    {}
+  };
+
+  tree empty () {
+    return tree{constructor<empty_t>{}};
+  }
+
+  tree insert (tree const& t, std::string const& k) {
+    return t.match<tree>(
+      [&](empty_t) {
+        return tree{constructor<node_t>{}, k, empty (), empty ()};
+      },
+      [&](node_t const& n) {
+        if (k < n.data)
+          return tree{constructor<node_t>{}, n.data
+            , insert (n.left_child, k), n.right_child};
+        if (n.data < k)
+          return tree{constructor<node_t>{}, n.data
+            , n.left_child, insert (n.right_child, k)};
+        return t;
+      });
+  }
+
+  tree insert (tree&& t, std::string const& k) {
+    return std::move (t).match<tree>(
+      [&](empty_t) {
+        return tree{constructor<node_t>{}, k, empty (), empty ()};
+      },
+      [&](node_t&& n) {
+        if (k < n.data)
+          return tree{constructor<node_t>{}, std::move (n.data)
+            , insert (std::move (n.left_child), k)
+            , std::move (n.right_child)};
+        if (n.data < k)
+          return tree{constructor<node_t>{}, std::move (n.data)
+            , std::move (n.left_child)
+            , insert (std::move (n.right_child), k)};
+        return tree{constructor<node_t>{}, std::move (n.data)
+          , std::move (n.left_child), std::move (n.right_child)};
+      });
+  }
+
+  //Nanoseconds per insertion
+  template <class F>
+  double run (std::vector<std::string> const& keys, F f) {
+    return pgs_bench::ns_per_op ([&]() {
+        tree t = empty ();
+        for (std::string const& k : keys)
+          t = f (t, k);
+        pgs_bench::escape (t);
+      }, keys.size ());
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1024; ++i)
+    keys.push_back (
+      "a key long enough to be allocated " + std::to_string ((i * 617) % 1031));
+
+  pgs_bench::report ("insert 1024 keys", "copy",
+    run (keys, [](tree& t, std::string const& k) {
+        return insert (static_cast<tree const&>(t), k);
+      }));
+  pgs_bench::report ("insert 1024 keys", "consume",
+    run (keys, [](tree& t, std::string const& k) {
+        return insert (std::move (t), k);
+      }));
+
+  return 0;
+}
@@ -0,0 +1,122 @@
+//Copy and destruction costs of the lists and trees of the tests with
+//deep-copying (`recursive_wrapper<>`) and sharing
+//(`shared_recursive_wrapper<>`, atomic and plain counts) boxes
+
+#include "benchmark.hpp"
+
+#include <pgs/pgs.hpp>
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  template <class T> using deep = recursive_wrapper<T>;
+  template <class T> using atomic = shared_recursive_wrapper<T, atomic_count>;
+  template <class T> using plain = shared_recursive_wrapper<T, plain_count>;
+
+  struct nil_t {};
+
+  template <template <class> class W> struct cons_t;
+  template <template <class> class W>
+  using list = sum_type<W<cons_t<W>>, nil_t>;
+
+  template <template <class> class W>
+  struct cons_t {
+    int hd;
+    list<W> tl;
+    cons_t (int hd, list<W> tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+
+  template <template <class> class W>
+  list<W> iota (int n) {
+    list<W> l{constructor<nil_t>{}};
+    for (int i = 0; i < n; ++i)
+      l = list<W>{constructor<cons_t<W>>{}, i, std::move (l)};
+    return l;
+  }
+
+  struct empty_t {};
+
+  template <template <class> class W> struct node_t;
+  template <template <class> class W>
+  using tree = sum_type<empty_t, W<node_t<W>>>;
+
+  template <template <class> class W>
+  struct node_t {
+    int key;
+    tree<W> left, right;
+    node_t (int key, tree<W> left, tree<W> right)
+      : key {key}, left (std::move (left)), right (std::move (right))
+    {}
+  };
+
+  template <template <class> class W>
+  tree<W> insert (tree<W> const& t, int k) {
+    return t.template match<tree<W>>(
+      [k](empty_t const&) {
+        return tree<W>{constructor<node_t<W>>{}
+          , k, tree<W>{constructor<empty_t>{}}, tree<W>{constructor<empty_t>{}}};
+      },
+      [&t, k](node_t<W> const& n) {
+        if (k == n.key)
+          return t;
+        if (k < n.key)
+          return tree<W>{
+            constructor<node_t<W>>{}, n.key, insert<W> (n.left, k), n.right};
+        return tree<W>{
+          constructor<node_t<W>>{}, n.key, n.left, insert<W> (n.right, k)};
+      });
+  }
+
+  template <template <class> class W>
+  void run (char const* variant) {
+    int const n = 1000;
+
+    //Copy a list into many slots and destroy the copies
+    {
+      list<W> const l = iota<W> (n);
+      std::size_t const copies = 1000;
+      pgs_bench::report ("list: copy + destroy", variant,
+        pgs_bench::ns_per_op ([&]() {
+          std::vector<list<W>> v (copies, l);
+          pgs_bench::escape (v);
+        }, copies));
+    }
+
+    //Build a list and destroy it
+    pgs_bench::report ("list: build + destroy", variant,
+      pgs_bench::ns_per_op ([&]() {
+        list<W> l = iota<W> (n);
+        pgs_bench::escape (l);
+      }, n));
+
+    //Insert keys persistently into a tree (the sub-trees off the path
+    //to the key are copied), destroy it
+    std::vector<int> keys (n);
+    std::mt19937 g {42};
+    for (int& k : keys)
+      k = static_cast<int>(g () % 1000000);
+    pgs_bench::report ("tree: insert + destroy", variant,
+      pgs_bench::ns_per_op ([&]() {
+        tree<W> t{constructor<empty_t>{}};
+        for (int k : keys)
+          t = insert<W> (t, k);
+        pgs_bench::escape (t);
+      }, n));
+  }
+
+}//namespace<anonymous>
+
+int main () {
+  run<deep> ("recursive_wrapper");
+  run<atomic> ("shared, atomic_count");
+  run<plain> ("shared, plain_count");
+
+  return 0;
+}
@@ -0,0 +1,181 @@
+#if !defined (ARENA_8F27D3B1_4C6A_4E09_A2D5_61B9E0C7F384_H)
+#  define ARENA_8F27D3B1_4C6A_4E09_A2D5_61B9E0C7F384_H
+
+//! \file arena.hpp
+//!
+//! \brief A monotonic region and an allocator drawing from it
+//!
+//! Recursive values (expression and parse trees, lists) are often
+//! built up, used and then thrown away as a whole. Allocating their
+//! nodes from an `arena` (by way of `arena_allocator<>` as the
+//! allocator of `recursive_wrapper<>`) makes allocation a pointer bump
+//! and, when the destruction of the nodes is skipped (see
+//! `arena_skips_destruction<>`), makes tearing down the structure a
+//! matter of releasing the region.
+
+#  include <cstddef>
+#  include <new>
+#  include <type_traits>
+
+namespace pgs {
+
+  //! \class arena
+  //!
+  //! \brief A monotonic region of memory
+  //!
+  //! Memory is obtained in chunks of geometrically increasing size
+  //! and handed out by bumping a pointer. Nothing is given back until
+  //! `release ()` (or the destructor) frees every chunk at once.
+  class arena {
+  private:
+    struct chunk {
+      chunk* next;
+    };
+
+    chunk* head_;
+    char* cur_;
+    char* end_;
+    std::size_t next_size_;
+
+  public:
+
+    //! \brief Ctor
+    //!
+    //! \param initial_size The size in bytes of the first chunk
+    explicit arena (std::size_t initial_size = 64 * 1024) noexcept
+      : head_ {nullptr}, cur_ {nullptr}, end_ {nullptr}
+      , next_size_ {initial_size}
+    {}
+
+    arena (arena const&) = delete;
+    arena& operator= (arena const&) = delete;
+
+    //! \brief Dtor (releases the region)
+    ~arena () {
+      release ();
+    }
+
+    //! \brief Obtain `n` bytes aligned to `alignment` (no more than
+    //! `alignof (std::max_align_t)`)
+    void* allocate (std::size_t n, std::size_t alignment) {
+      std::size_t const pad =
+        (alignment - reinterpret_cast<std::size_t>(cur_) % alignment)
+          % alignment;
+      if (cur_ == nullptr || static_cast<std::size_t>(end_ - cur_) < n + pad) {
+        grow (n);
+        return allocate (n, alignment);
+      }
+      void* p = cur_ + pad;
+      cur_ += pad + n;
+      return p;
+    }
+
+    //! \brief Free every chunk (everything allocated from the region
+    //! is invalidated)
+    void release () noexcept {
+      while (head_ != nullptr) {
+        chunk* next = head_->next;
+        ::operator delete (head_);
+        head_ = next;
+      }
+      cur_ = end_ = nullptr;
+    }
+
+  private:
+    void grow (std::size_t n) {
+      std::size_t const header =
+        (sizeof (chunk) + alignof (std::max_align_t) - 1)
+          / alignof (std::max_align_t) * alignof (std::max_align_t);
+      while (next_size_ < n + header)
+        next_size_ *= 2;
+      chunk* c = static_cast<chunk*>(::operator new (next_size_));
+      c->next = head_;
+      head_ = c;
+      cur_ = reinterpret_cast<char*>(c) + header;
+      end_ = reinterpret_cast<char*>(c) + next_size_;
+      next_size_ *= 2;
+    }
+  };
+
+  //! \brief A metafunction to determine if objects of type `T`
+  //! allocated by an `arena_allocator<>` are left undestroyed
+  //!
+  //! Trivially destructible types are. Specialize this template (to
+  //! derive from `std::true_type`) to have the destructor of a node
+  //! type skipped too : when the root of a structure of such nodes is
+  //! destroyed, the destruction stops there (the nodes below are not
+  //! visited) and the memory is reclaimed by releasing the `arena`.
+  //! Only opt in types that own no resources other than memory in the
+  //! same `arena`.
+  //!
+  //! \tparam T The type of object
+  template <class T>
+  struct arena_skips_destruction : std::is_trivially_destructible<T>
+  {};
+
+  //! \class arena_allocator
+  //!
+  //! \brief An allocator drawing from an `arena`
+  //!
+  //! Deallocation is a no-op, as is destruction of objects of types
+  //! for which `arena_skips_destruction<>` holds.
+  //!
+  //! \tparam T The type of object allocated
+  template <class T>
+  struct arena_allocator {
+    using value_type = T; //!< The type of object allocated
+
+    arena* region; //!< The region allocated from
+
+    //! \brief Ctor
+    explicit arena_allocator (arena& a) noexcept : region {&a}
+    {}
+
+    //! \brief Converting ctor
+    template <class U>
+    arena_allocator (arena_allocator<U> const& a) noexcept
+      : region {a.region}
+    {}
+
+    //! \brief Allocate storage for `n` objects of type `T`
+    T* allocate (std::size_t n) {
+      static_assert (alignof (T) <= alignof (std::max_align_t)
+        , "over-aligned types are not supported");
+      return static_cast<T*>(region->allocate (n * sizeof (T), alignof (T)));
+    }
+
+    //! \brief A no-op
+    void deallocate (T*, std::size_t) noexcept {
+    }
+
+    //! \brief Destroy `*p` (unless `arena_skips_destruction<U>`)
+    template <class U>
+    void destroy (U* p) {
+      destroy (p, arena_skips_destruction<U>{});
+    }
+
+  private:
+    template <class U>
+    static void destroy (U* p, std::false_type) {
+      p->~U ();
+    }
+    template <class U>
+    static void destroy (U*, std::true_type) {
+    }
+  };
+
+  //! \brief `true` if `l` and `r` allocate from the same `arena`
+  template <class T, class U>
+  bool operator== (arena_allocator<T> const& l, arena_allocator<U> const& r) {
+    return l.region == r.region;
+  }
+
+  //! \brief `true` if `l` and `r` allocate from different `arena`s
+  template <class T, class U>
+  bool operator!= (arena_allocator<T> const& l, arena_allocator<U> const& r) {
+    return l.region != r.region;
+  }
+
+}//namespace pgs
+
+#endif //!defined (ARENA_8F27D3B1_4C6A_4E09_A2D5_61B9E0C7F384_H)
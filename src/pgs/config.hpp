@@ -0,0 +1,46 @@
+#if !defined (CONFIG_EC38DB79_5ABC_4A54_8C3A_BF1D46FEE094_H)
+#  define CONFIG_EC38DB79_5ABC_4A54_8C3A_BF1D46FEE094_H
+
+//! \file config.hpp
+//!
+//! \brief Build configuration
+//!
+//! The library may be used without exceptions (`-fno-exceptions`).
+//! `PGS_NO_EXCEPTIONS` is then defined (by the user or, when the
+//! compiler is seen to have exceptions disabled, here). Nothing is
+//! thrown : an invalid access into a sum is reported to the invalid
+//! access handler (see `set_invalid_access_handler ()`), which by
+//! default prints a diagnostic and aborts. Errors raised by the cases
+//! (and their allocators) are those of the cases.
+
+#  if !defined (PGS_NO_EXCEPTIONS)
+#    if defined (__GNUC__) && !defined (__EXCEPTIONS)
+#      define PGS_NO_EXCEPTIONS
+#    elif defined (_MSC_VER) && !defined (_CPPUNWIND)
+#      define PGS_NO_EXCEPTIONS
+#    endif
+#  endif//!defined (PGS_NO_EXCEPTIONS)
+
+//! \cond
+#  if defined (PGS_NO_EXCEPTIONS)
+#    define PGS_TRY if (true)
+#    define PGS_CATCH_ALL else
+#    define PGS_RETHROW
+#  else
+#    define PGS_TRY try
+#    define PGS_CATCH_ALL catch (...)
+#    define PGS_RETHROW throw;
+#  endif//defined (PGS_NO_EXCEPTIONS)
+
+//A function that is rarely called (error paths) : kept out of line
+//and away from hot code
+#  if defined (__GNUC__)
+#    define PGS_COLD __attribute__ ((noinline, cold))
+#  elif defined (_MSC_VER)
+#    define PGS_COLD __declspec (noinline)
+#  else
+#    define PGS_COLD
+#  endif
+//! \endcond
+
+#endif //!defined (CONFIG_EC38DB79_5ABC_4A54_8C3A_BF1D46FEE094_H)
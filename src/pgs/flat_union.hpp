@@ -0,0 +1,286 @@
+#if !defined (FLAT_UNION_5B0E6C6B_2F0D_4B8E_9A55_3C1F3B7F2E41_H)
+#  define FLAT_UNION_5B0E6C6B_2F0D_4B8E_9A55_3C1F3B7F2E41_H
+
+//! \file flat_union.hpp
+//!
+//! \brief A type modeling a "flat union".
+//!
+//! An alternative to `recursive_union<>` as the implementation
+//! mechanism of the sum type. Rather than nesting a union per case,
+//! a single buffer large enough (and sufficiently aligned) for any of
+//! the cases is used and the operations on the value it holds are
+//! looked up in tables indexed by the active index.
+
+#  include <pgs/recursive_union.hpp>
+
+#  include <cstddef>
+#  include <memory>
+#  include <new>
+#  include <tuple>
+#  include <type_traits>
+
+namespace pgs {
+
+  //! \cond
+  namespace detail {
+
+    constexpr std::size_t flat_union_max (
+      std::size_t const* xs, std::size_t n, std::size_t acc = 0) {
+      return n == 0 ? acc
+        : flat_union_max (xs + 1, n - 1, *xs > acc ? *xs : acc);
+    }
+
+    template <class... Ts>
+    struct flat_union_extent {
+      static constexpr std::size_t sizes[] = {sizeof (Ts)...};
+      static constexpr std::size_t alignments[] = {alignof (Ts)...};
+
+      static constexpr std::size_t size =
+        flat_union_max (sizes, sizeof... (Ts));
+      static constexpr std::size_t alignment =
+        flat_union_max (alignments, sizeof... (Ts));
+    };
+
+    template <class... Ts>
+    constexpr std::size_t flat_union_extent<Ts...>::sizes[];
+    template <class... Ts>
+    constexpr std::size_t flat_union_extent<Ts...>::alignments[];
+
+    //The operations on a case `T` of a `flat_union<>` (entries of
+    //the tables of `flat_union<>`)
+    template <class T>
+    struct flat_union_case {
+      static void copy (void* dst, void const* src) {
+        new (dst) T (*static_cast<T const*>(src));
+      }
+      static void move (void* dst, void* src) {
+        new (dst) T (std::move (*static_cast<T*>(src)));
+      }
+      static void assign (void* dst, void const* src) {
+        case_assign (*static_cast<T*>(dst), *static_cast<T const*>(src));
+      }
+      static void move_assign (void* dst, void* src) {
+        case_move_assign (
+          *static_cast<T*>(dst), std::move (*static_cast<T*>(src)));
+      }
+      static void destruct (void* p) {
+        static_cast<T*>(p)->~T ();
+      }
+      static bool compare (void const* lhs, void const* rhs) {
+        return *static_cast<T const*>(lhs) == *static_cast<T const*>(rhs);
+      }
+      static std::size_t hash (void const* p) {
+        return case_hash (*static_cast<T const*>(p));
+      }
+    };
+
+    //Dereference (through a `recursive_wrapper<>` if needs be)
+    template <class T>
+    constexpr T& flat_union_unwrap (T& t) { return t; }
+    template <class T>
+    constexpr T const& flat_union_unwrap (T const& t) { return t; }
+    template <class T, class A>
+    T& flat_union_unwrap (recursive_wrapper<T, A>& t) { return t.get (); }
+    template <class T, class A>
+    T const& flat_union_unwrap (recursive_wrapper<T, A> const& t) {
+      return t.get ();
+    }
+    template <class T, class C>
+    T& flat_union_unwrap (shared_recursive_wrapper<T, C>& t) {
+      return t.get ();
+    }
+    template <class T, class C>
+    T const& flat_union_unwrap (shared_recursive_wrapper<T, C> const& t) {
+      return t.get ();
+    }
+
+    //The address of the value (through a `recursive_wrapper<>` if
+    //needs be)
+    template <class T>
+    T* flat_union_address (T& t) { return std::addressof (t); }
+    template <class T, class A>
+    T* flat_union_address (recursive_wrapper<T, A>& t) {
+      return t.get_pointer ();
+    }
+    template <class T, class C>
+    T* flat_union_address (shared_recursive_wrapper<T, C>& t) {
+      return t.get_pointer ();
+    }
+
+  }//namespace detail
+  //! \endcond
+
+  //! \class flat_union
+  //!
+  //! \brief A storage type for the sum type in which all cases share
+  //! one buffer
+  //!
+  //! The buffer has the size of the largest and the alignment of the
+  //! most aligned of `Ts...`. Copy, move, destruction and comparison
+  //! are each a single indirect call through a table indexed by the
+  //! active index and the number of instantiations needed does not
+  //! grow with the position of a case in `Ts...`.
+  //!
+  //! `flat_union<>` provides the same interface as
+  //! `recursive_union<>` and can be substituted for it in a
+  //! `sum_type<>` by specializing `sum_type_storage<>`.
+  //!
+  //! \tparam Ts The cases of the union
+  template <class... Ts>
+  struct flat_union {
+  private:
+    using extent = detail::flat_union_extent<Ts...>;
+
+    typename std::aligned_storage<
+      extent::size, extent::alignment>::type buf;
+
+    template <class U>
+    using index_of_case = index_of<U, Ts...>;
+
+  public:
+
+    //! \brief The type (as stored, that is before unwrapping any
+    //! `recursive_wrapper<>`) at index `I` of `Ts...`
+    template <std::size_t I>
+    using type_at_storage =
+      typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+    //! \brief Default ctor
+    flat_union ()
+    {}
+
+    //! \brief Construct the case of `Ts...` that is `U` or is a
+    //! `recursive_wrapper<U>` into the buffer
+    template <class U, class... Args>
+    explicit flat_union (constructor<U>, Args&&... args)
+      noexcept (std::is_nothrow_constructible<
+        type_at_storage<index_of_case<U>::value>, Args...>::value) {
+      using T = type_at_storage<index_of_case<U>::value>;
+      new (address ()) T (std::forward<Args>(args)...);
+    }
+
+    //! \brief Copy
+    //!
+    //! Copy-construct the value of `u` at index `i` into the buffer
+    void copy (std::size_t i, flat_union const& u)
+      noexcept (and_<std::is_nothrow_copy_constructible<Ts>...>::value) {
+      using entry_type = void (*)(void*, void const*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::copy...
+      };
+      table[i] (address (), u.address ());
+    }
+
+    //! \brief Move
+    //!
+    //! Move-construct the value of `u` at index `i` into the buffer
+    void move (std::size_t i, flat_union&& u)
+      noexcept (and_<std::is_nothrow_move_constructible<Ts>...>::value) {
+      using entry_type = void (*)(void*, void*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::move...
+      };
+      table[i] (address (), u.address ());
+    }
+
+    //! \brief Copy-assign
+    //!
+    //! Copy-assign the value of `u` at index `i` to the (active)
+    //! value at index `i`
+    void assign (std::size_t i, flat_union const& u) {
+      using entry_type = void (*)(void*, void const*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::assign...
+      };
+      table[i] (address (), u.address ());
+    }
+
+    //! \brief Move-assign
+    //!
+    //! Move-assign the value of `u` at index `i` to the (active)
+    //! value at index `i`
+    void move_assign (std::size_t i, flat_union&& u)
+      noexcept (and_<detail::is_nothrow_case_move_assignable<Ts>...>::value) {
+      using entry_type = void (*)(void*, void*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::move_assign...
+      };
+      table[i] (address (), u.address ());
+    }
+
+    //! \brief Destruct
+    //!
+    //! Destroy the value at index `i`
+    void destruct (std::size_t i)
+      noexcept (and_<std::is_nothrow_destructible<Ts>...>::value) {
+      using entry_type = void (*)(void*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::destruct...
+      };
+      table[i] (address ());
+    }
+
+    //! \brief Equality comparison
+    //!
+    //! Compare the values at index `i` of self and `rhs`
+    bool compare (std::size_t i, flat_union const& rhs) const noexcept {
+      using entry_type = bool (*)(void const*, void const*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::compare...
+      };
+      return table[i] (address (), rhs.address ());
+    }
+
+    //! \brief Hash
+    //!
+    //! Hash the value at index `i`
+    std::size_t hash (std::size_t i) const {
+      using entry_type = std::size_t (*)(void const*);
+      static constexpr entry_type table[] = {
+        &detail::flat_union_case<Ts>::hash...
+      };
+      return table[i] (address ());
+    }
+
+    //! \brief The address of the buffer
+    void* address () noexcept { return &buf; }
+    //! \brief The address of the buffer
+    void const* address () const noexcept { return &buf; }
+  };
+
+  //! \brief Produce a non-`const` reference to the `I`th value of a
+  //! `flat_union<>` (the object referred to if that value is a
+  //! `recursive_wrapper<>`)
+  template <std::size_t I, class... Ts>
+  auto union_ref (flat_union<Ts...>& u)
+    -> decltype (detail::flat_union_unwrap (
+         std::declval<typename flat_union<Ts...>::template type_at_storage<I>&>())) {
+    using T = typename flat_union<Ts...>::template type_at_storage<I>;
+    return detail::flat_union_unwrap (*static_cast<T*>(u.address ()));
+  }
+
+  //! \brief Produce a `const` reference to the `I`th value of a
+  //! `flat_union<>` (the object referred to if that value is a
+  //! `recursive_wrapper<>`)
+  template <std::size_t I, class... Ts>
+  auto union_ref (flat_union<Ts...> const& u)
+    -> decltype (detail::flat_union_unwrap (
+         std::declval<typename flat_union<Ts...>::template type_at_storage<I> const&>())) {
+    using T = typename flat_union<Ts...>::template type_at_storage<I>;
+    return detail::flat_union_unwrap (*static_cast<T const*>(u.address ()));
+  }
+
+  //! \brief Produce a pointer to the `I`th value of a `flat_union<>`
+  //! (the object referred to if that value is a `recursive_wrapper<>`,
+  //! `nullptr` if that wrapper has been moved from)
+  template <std::size_t I, class... Ts>
+  auto union_ptr (flat_union<Ts...>& u)
+    -> decltype (detail::flat_union_address (
+         std::declval<typename flat_union<Ts...>::template type_at_storage<I>&>())) {
+    using T = typename flat_union<Ts...>::template type_at_storage<I>;
+    return detail::flat_union_address (*static_cast<T*>(u.address ()));
+  }
+
+}//namespace pgs
+
+#endif //!defined (FLAT_UNION_5B0E6C6B_2F0D_4B8E_9A55_3C1F3B7F2E41_H)
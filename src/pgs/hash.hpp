@@ -0,0 +1,49 @@
+#if !defined (HASH_A47C0E19_6B2D_4F83_9E51_C8D3F26B70A4_H)
+#  define HASH_A47C0E19_6B2D_4F83_9E51_C8D3F26B70A4_H
+
+//! \file hash.hpp
+//!
+//! \brief Support for hashing sums structurally
+//!
+//! The hash of a `sum_type<>` combines its active index with the hash
+//! of its active value (`std::hash<>` of the case, seen through any
+//! recursive wrapper). The hash of a value that carries no data (an
+//! empty case such as `nil_t`) is taken to be zero so that such cases
+//! need not specialize `std::hash<>`.
+
+#  include <cstddef>
+#  include <functional>
+#  include <type_traits>
+
+namespace pgs {
+
+  //! \brief Mix the hash `h` into the hash `seed`
+  inline std::size_t hash_combine (std::size_t seed, std::size_t h) noexcept {
+    return seed ^ (h + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+  }
+
+  //! \cond
+  namespace detail {
+
+    template <class T>
+    std::size_t case_hash (T const&, std::true_type) noexcept {
+      return 0;
+    }
+
+    template <class T>
+    std::size_t case_hash (T const& t, std::false_type) {
+      return std::hash<T>{}(t);
+    }
+
+    //The hash of the value of a case of a sum
+    template <class T>
+    std::size_t case_hash (T const& t) {
+      return case_hash (t, std::is_empty<T>{});
+    }
+
+  }//namespace detail
+  //! \endcond
+
+}//namespace pgs
+
+#endif //!defined (HASH_A47C0E19_6B2D_4F83_9E51_C8D3F26B70A4_H)
@@ -0,0 +1,235 @@
+#if !defined (HASH_CONS_5E81C2A4_93B7_4F0D_A6C3_2D7B18E94F05_H)
+#  define HASH_CONS_5E81C2A4_93B7_4F0D_A6C3_2D7B18E94F05_H
+
+//! \file hash_cons.hpp
+//!
+//! \brief Maximal sharing of structurally equal recursive values
+//!
+//! Hash-consing builds every node of a recursive value through an
+//! intern table : a node structurally equal to one that is live is not
+//! built again, the live node is shared instead. Structurally equal
+//! values are then the same node. Equality is identity of nodes
+//! (constant time) and node addresses make keys for memoization.
+//!
+//! The table is weak : it does not keep nodes alive. A node leaves the
+//! table when its last reference goes.
+//!
+//! The table is shared by all threads. It is divided into shards
+//! (see `intern_shards<>`), each with its own lock, so that threads
+//! interning different nodes rarely contend.
+
+#  include <pgs/shared_recursive_wrapper.hpp>
+
+#  include <atomic>
+#  include <cstddef>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <type_traits>
+#  include <unordered_map>
+#  include <utility>
+
+namespace pgs {
+
+  //! \cond
+  template <class T, class H = std::hash<T>, class E = std::equal_to<T>>
+  struct interned_count; //fwd. decl.
+  //! \endcond
+
+  //! \brief The type of a reference to an interned node of type `T`
+  //! (a case of a `sum_type<>` in place of `recursive_wrapper<T>`)
+  //!
+  //! \tparam T The type of the node's value
+  //! \tparam H The hash function of values of type `T`
+  //! \tparam E The equality of values of type `T`
+  template <class T, class H = std::hash<T>, class E = std::equal_to<T>>
+  using interned = shared_recursive_wrapper<T, interned_count<T, H, E>>;
+
+  //! \brief A metafunction to determine the number of shards of the
+  //! intern table of type `T`
+  //!
+  //! The default is 64. Specialize this template (to derive from
+  //! `std::integral_constant<std::size_t, N>`) to change it.
+  //!
+  //! \tparam T The type of the node's value
+  template <class T>
+  struct intern_shards : std::integral_constant<std::size_t, 64>
+  {};
+
+  //! \cond
+  namespace detail {
+
+    //The live interned nodes of type `T`, by hash. There is one table
+    //per `T` (shared by all threads), made of shards selected by hash
+    //
+    //A node is reclaimed safely : the thread dropping its last
+    //reference takes it out of its shard (under the shard's lock)
+    //before deleting it, and meanwhile a lookup finding it declines
+    //to take a reference to it (its count is zero) and interns a new
+    //node in its place
+    template <class T, class H, class E>
+    class intern_table {
+    public:
+      using node_type = shared_recursive_node<T, interned_count<T, H, E>>;
+
+    private:
+      static constexpr std::size_t shard_count = intern_shards<T>::value;
+      static_assert (shard_count > 0, "an intern table needs a shard");
+
+      struct shard {
+        std::mutex mutex;
+        std::unordered_multimap<std::size_t, node_type*> nodes;
+        char pad[64]; //keeps the locks of shards off each other's
+                      //cache lines
+      };
+
+      std::unique_ptr<shard[]> shards_;
+      H hash_;
+      E equal_;
+
+      intern_table () : shards_ (new shard[shard_count])
+      {}
+
+      //The shard of hash `h` (`h` is mixed as hashes of addresses
+      //have their low bits clear)
+      shard& shard_of (std::size_t h) const noexcept {
+        std::size_t const m =
+          h * static_cast<std::size_t>(0x9E3779B97F4A7C15ull);
+        return shards_[(m >> (sizeof (std::size_t) * 8 - 16)) % shard_count];
+      }
+
+    public:
+      intern_table (intern_table const&) = delete;
+      intern_table& operator= (intern_table const&) = delete;
+
+      static intern_table& instance () {
+        //Never destroyed : interned values may be destroyed during
+        //static destruction
+        static intern_table* table = new intern_table;
+        return *table;
+      }
+
+      //A (counted) reference to the live node equal to `value` if
+      //there is one, else to a new node taking `value`
+      node_type* intern (T&& value) {
+        std::size_t const h = hash_ (value);
+        shard& s = shard_of (h);
+        std::lock_guard<std::mutex> lock (s.mutex);
+        auto range = s.nodes.equal_range (h);
+        for (auto it = range.first; it != range.second; ++it) {
+          node_type* p = it->second;
+          //A node whose last reference has gone is on its way out
+          if (equal_ (p->value, value)
+              && interned_count<T, H, E>::acquire (p->count))
+            return p;
+        }
+        std::unique_ptr<node_type> p (new node_type (std::move (value)));
+        s.nodes.emplace (h, p.get ());
+        return p.release ();
+      }
+
+      //Forget `p` (if it is interned)
+      void erase (node_type* p) noexcept {
+        std::size_t const h = hash_ (p->value);
+        shard& s = shard_of (h);
+        std::lock_guard<std::mutex> lock (s.mutex);
+        auto range = s.nodes.equal_range (h);
+        for (auto it = range.first; it != range.second; ++it) {
+          if (it->second == p) {
+            s.nodes.erase (it);
+            return;
+          }
+        }
+      }
+
+      std::size_t size () {
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < shard_count; ++i) {
+          std::lock_guard<std::mutex> lock (shards_[i].mutex);
+          n += shards_[i].nodes.size ();
+        }
+        return n;
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief The reference counting policy of interned nodes
+  //!
+  //! Counts are atomic. Disposing of a node removes it from the intern
+  //! table.
+  template <class T, class H, class E>
+  struct interned_count : atomic_count {
+    //! \brief Count a new reference unless the count has dropped to
+    //! zero (`true` if it has not)
+    static bool acquire (value_type& c) noexcept {
+      std::size_t n = c.load (std::memory_order_relaxed);
+      while (n != 0) {
+        if (c.compare_exchange_weak (n, n + 1, std::memory_order_relaxed))
+          return true;
+      }
+      return false;
+    }
+    //! \brief Remove a node whose last reference has gone from the
+    //! intern table and delete it
+    template <class N>
+    static void dispose (N* p) noexcept {
+      detail::intern_table<T, H, E>::instance ().erase (p);
+      delete p;
+    }
+  };
+
+  //! \class hash_cons
+  //!
+  //! \brief A factory of interned nodes of type `T`
+  //!
+  //! For sharing to be maximal, the children of an interned node
+  //! should themselves be interned. Then `H` and `E` need only look
+  //! one level down : children are equal if and only if they are the
+  //! same node (so `H` may hash a child by its address).
+  //!
+  //! \code{.cpp}
+  //!   struct add_t;
+  //!   using xpr_t = sum_type<cst_t, interned<add_t>>;
+  //!   struct add_t { xpr_t l, r; };
+  //!
+  //!   xpr_t add (xpr_t l, xpr_t r) {
+  //!     return xpr_t{constructor<add_t>{}
+  //!       , hash_cons<add_t>::make (std::move (l), std::move (r))};
+  //!   }
+  //! \endcode
+  //!
+  //! Interned values must not be modified (the table would no longer
+  //! find them). Nodes built other than by `make ()` (e.g. by
+  //! constructing an `interned<T>` from a `T`) are not shared.
+  //!
+  //! \tparam T The type of the node's value
+  //! \tparam H The hash function of values of type `T`
+  //! \tparam E The equality of values of type `T`
+  template <class T, class H = std::hash<T>, class E = std::equal_to<T>>
+  struct hash_cons {
+    //! \brief The type of a reference to an interned node
+    using wrapper_type = interned<T, H, E>;
+
+    //! \brief A reference to the live node equal to `T (args...)` (a
+    //! new node if there is none)
+    template <class... Args>
+    static wrapper_type make (Args&&... args) {
+      T value (std::forward<Args>(args)...);
+      return wrapper_type (adopt_t{}, table::instance ().intern (
+        std::move (value)));
+    }
+
+    //! \brief The number of live interned nodes of type `T`
+    static std::size_t size () {
+      return table::instance ().size ();
+    }
+
+  private:
+    using table = detail::intern_table<T, H, E>;
+  };
+
+}//namespace pgs
+
+#endif //!defined (HASH_CONS_5E81C2A4_93B7_4F0D_A6C3_2D7B18E94F05_H)
@@ -0,0 +1,251 @@
+#if !defined (MATCH_21136E7A_5AE6_43EB_B4EB_DE396284853F_H)
+#  define MATCH_21136E7A_5AE6_43EB_B4EB_DE396284853F_H
+
+//! \file match.hpp
+//!
+//! \brief Matching on several sums at once
+//!
+//! `match (s1, ..., sn, fs...)` applies to the active values of the
+//! sums `s1`, ..., `sn` the first of the handlers `fs...` that accepts
+//! all of them (as `f (v1, ..., vn)`). The combination of the active
+//! indices subscripts a single table (flattened : one entry per
+//! combination of cases) so that dispatch is one indirect call, where
+//! nested `match`es dispatch once for each sum.
+
+#  include <pgs/match_table.hpp>
+#  include <pgs/recursive_union.hpp>
+#  include <pgs/sum_type.hpp>
+
+#  include <cstddef>
+#  include <cstdlib>
+#  include <tuple>
+#  include <type_traits>
+#  include <utility>
+
+namespace pgs {
+
+  //! \cond
+  namespace detail {
+
+    template <class T>
+    struct is_sum_type : std::false_type
+    {};
+
+    template <class... Ts>
+    struct is_sum_type<sum_type<Ts...>> : std::true_type
+    {};
+
+    //The number of sums `Args...` starts with
+    template <class... Args>
+    struct leading_sums : std::integral_constant<std::size_t, 0>
+    {};
+
+    template <class A, class... Args>
+    struct leading_sums<A, Args...>
+      : std::integral_constant<std::size_t,
+          is_sum_type<decay_t<A>>::value
+            ? 1 + leading_sums<Args...>::value
+            : 0>
+    {};
+
+    template <class S>
+    struct sum_type_size;
+
+    template <class... Ts>
+    struct sum_type_size<sum_type<Ts...>>
+      : std::integral_constant<std::size_t, sizeof... (Ts)>
+    {};
+
+    //The indices `Z`, ..., `E - 1`
+    template <std::size_t Z, std::size_t E>
+    struct index_span {
+      using type = range_t<Z, E - 1>;
+    };
+
+    template <std::size_t Z>
+    struct index_span<Z, Z> {
+      using type = range<>;
+    };
+
+    //The product of `n[0]`, ..., `n[k - 1]`
+    constexpr std::size_t product (std::size_t const* n, std::size_t k) {
+      return k == 0 ? 1 : n[k - 1] * product (n, k - 1);
+    }
+
+    //The stride of the `k`th of the `c` dimensions `n` of a table
+    //(laid out with the last dimension varying fastest)
+    constexpr std::size_t stride (
+      std::size_t const* n, std::size_t k, std::size_t c) {
+      return k + 1 >= c ? 1 : n[k + 1] * stride (n, k + 1, c);
+    }
+
+    //Apply `f` to `as...`
+    template <class R, bool Handled = true>
+    struct handler_invoke {
+      template <class F, class... As>
+      static R apply (F&& f, As&&... as) {
+        return std::forward<F>(f)(std::forward<As>(as)...);
+      }
+    };
+
+    template <>
+    struct handler_invoke<void, true> {
+      template <class F, class... As>
+      static void apply (F&& f, As&&... as) {
+        std::forward<F>(f)(std::forward<As>(as)...);
+      }
+    };
+
+    //No handler : not reached (see `handler_call<R, false>`)
+    template <class R>
+    struct handler_invoke<R, false> {
+      template <class... Args>
+      static R apply (Args&&...) {
+        std::abort ();
+      }
+    };
+
+    //Dispatch on the active cases of the sums at `Ks...` of `args`
+    //to the first of the handlers at `Js...` that accepts them
+    template <class R, class Ks, class Js, class... Args>
+    struct multi_dispatcher;
+
+    template <class R, std::size_t... Ks, std::size_t... Js, class... Args>
+    struct multi_dispatcher<R, range<Ks...>, range<Js...>, Args...> {
+
+      using args_type = std::tuple<Args&&...>;
+
+      template <std::size_t K>
+      using arg_type =
+        typename std::tuple_element<K, std::tuple<Args...>>::type;
+
+      //The number of cases of each sum
+      static constexpr std::size_t size[] = {
+        sum_type_size<decay_t<arg_type<Ks>>>::value..., 0
+      };
+
+      //The active index of each sum at the entry `X` of the table
+      template <std::size_t X>
+      using cases_at = range<
+        X / stride (size, Ks, sizeof... (Ks)) % size[Ks]...>;
+
+      template <class Cs>
+      struct entry;
+
+      //The entry of the combination of cases `Cs...`
+      template <std::size_t... Cs>
+      struct entry<range<Cs...>> {
+
+        using arguments_type = arguments<
+          decltype (forward_case<arg_type<Ks>, Cs> (union_ref<Cs> (
+            sum_type_accessor::storage (
+              std::get<Ks> (std::declval<args_type&> ())))))...>;
+
+        static constexpr std::size_t handler = handler_index<
+          arguments_type, arg_type<Js>...>::value;
+
+        static constexpr std::size_t selected =
+          handler != no_handler ? sizeof... (Ks) + handler : 0;
+
+        static R visit (args_type& args) {
+          static_assert (handler != no_handler
+            , "pgs::match : no handler accepts a combination of cases of "
+              "the sums");
+          return handler_invoke<R, handler != no_handler>::apply (
+              std::forward<arg_type<selected>> (std::get<selected> (args))
+            , forward_case<arg_type<Ks>, Cs> (union_ref<Cs> (
+                sum_type_accessor::storage (std::get<Ks> (args))))...);
+        }
+      };
+
+      template <class Xs>
+      struct table;
+
+      template <std::size_t... Xs>
+      struct table<range<Xs...>> {
+        static_assert (match_table<
+            std::tuple<typename entry<cases_at<Xs>>::arguments_type...>
+          , arg_type<Js>...>::irredundant
+          , "pgs::match : a handler is never applied (an earlier handler "
+            "accepts every combination of cases it does, or it accepts "
+            "none)");
+
+        using entry_type = R (*)(args_type&);
+        static constexpr entry_type entries[] = {
+          &entry<cases_at<Xs>>::visit...
+        };
+      };
+
+      static R visit (args_type& args) {
+        std::size_t const index[] = {
+          sum_type_accessor::active_index (std::get<Ks> (args))..., 0
+        };
+        std::size_t x = 0;
+        for (std::size_t k = 0; k != sizeof... (Ks); ++k)
+          x = x * size[k] + index[k];
+
+        return table<range_t<0, product (size, sizeof... (Ks)) - 1>
+          >::entries[x] (args);
+      }
+    };
+
+    template <class R, std::size_t... Ks, std::size_t... Js, class... Args>
+    constexpr std::size_t
+      multi_dispatcher<R, range<Ks...>, range<Js...>, Args...>::size[];
+
+    template <class R, std::size_t... Ks, std::size_t... Js, class... Args>
+      template <std::size_t... Xs>
+    constexpr typename multi_dispatcher<
+        R, range<Ks...>, range<Js...>, Args...>::template table<
+          range<Xs...>>::entry_type
+      multi_dispatcher<R, range<Ks...>, range<Js...>, Args...>::table<
+        range<Xs...>>::entries[];
+
+    template <class R, class... Args>
+    R multi_match (Args&&... args) {
+      static_assert (leading_sums<Args...>::value != 0
+        , "pgs::match : the first argument is not a sum");
+
+      using dispatcher = multi_dispatcher<R
+        , typename index_span<0, leading_sums<Args...>::value>::type
+        , typename index_span<
+            leading_sums<Args...>::value, sizeof... (Args)>::type
+        , Args...>;
+      std::tuple<Args&&...> all (std::forward<Args>(args)...);
+
+      return dispatcher::visit (all);
+    }
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief `match` function on several sums
+  //!
+  //! The arguments are the sums `s1`, ..., `sn` followed by the
+  //! handlers. The first handler that may be applied to the active
+  //! values of the sums (dereferenced through a `recursive_wrapper<>`
+  //! if needs be, and rvalues for the sums that are but for shared
+  //! cases, see `rvalue_type_at<>`), in order, is
+  //! applied to them. A combination of
+  //! cases that no handler accepts, or a handler that is never
+  //! applied (defaults, like `[](otherwise, otherwise) {...}`,
+  //! excepted), is a compile time error.
+  //!
+  //! \returns The result of the handler
+  template <class R, class... Args>
+  R match (Args&&... args) {
+    return detail::multi_match<R> (std::forward<Args>(args)...);
+  }
+
+  //! \brief `match` procedure on several sums (see `match<R>`)
+  //!
+  //! (The leading parameter stands in the way of `match<R>`, that would
+  //! otherwise name this function with `R` the type of the first sum)
+  template <int = 0, class... Args>
+  void match (Args&&... args) {
+    detail::multi_match<void> (std::forward<Args>(args)...);
+  }
+
+}//namespace pgs
+
+#endif //!defined (MATCH_21136E7A_5AE6_43EB_B4EB_DE396284853F_H)
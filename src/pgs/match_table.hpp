@@ -0,0 +1,187 @@
+#if !defined (MATCH_TABLE_61D897A5_45AD_473F_9645_459F43A06FED_H)
+#  define MATCH_TABLE_61D897A5_45AD_473F_9645_459F43A06FED_H
+
+//! \file match_table.hpp
+//!
+//! \brief The resolution of the handlers of a `match`
+//!
+//! A `match` applies to the active value the first of its handlers
+//! that accepts it. Which handler that is, for each case, is computed
+//! once, at compile time (`match_table<>`). Dispatch is then a direct
+//! call of that handler and a case that no handler accepts, or a
+//! handler that is never applied, is reported at compile time.
+
+#  include <cstddef>
+#  include <tuple>
+#  include <type_traits>
+#  include <utility>
+
+namespace pgs {
+
+  //! \brief The handler index of a case that no handler accepts
+  constexpr std::size_t no_handler = static_cast<std::size_t> (-1);
+
+  //! \cond
+  namespace detail {
+
+    //`F` may be applied to an argument of type `A` (a reference type :
+    //its `const`-ness and value category count and no copy is made)
+    template <class F, class A>
+    struct is_applicable {
+      template <class G, class B>
+      static auto check (int)
+        -> decltype ((void)std::declval<G>()(std::declval<B>())
+                   , std::true_type{});
+      template <class, class>
+      static std::false_type check (...);
+
+      static constexpr bool value = decltype (check<F, A> (0))::value;
+    };
+
+    //The types of the arguments of a handler applied to several
+    //values at once (`A` in `is_applicable<F, A>` is then an
+    //`arguments<As...>`)
+    template <class... As>
+    struct arguments {};
+
+    template <class F, class... As>
+    struct is_applicable<F, arguments<As...>> {
+      template <class G, class... Bs>
+      static auto check (int)
+        -> decltype ((void)std::declval<G>()(std::declval<Bs>()...)
+                   , std::true_type{});
+      template <class, class...>
+      static std::false_type check (...);
+
+      static constexpr bool value = decltype (check<F, As...> (0))::value;
+    };
+
+    //The index of the first of `Fs...` (the first being the `J`th)
+    //that may be applied to an `A`. The handlers after it are not
+    //tested
+    template <std::size_t J, class A, class... Fs>
+    struct first_applicable : std::integral_constant<std::size_t, no_handler>
+    {};
+
+    template <bool Applicable, std::size_t J, class A, class... Fs>
+    struct first_applicable_if : std::integral_constant<std::size_t, J>
+    {};
+
+    template <std::size_t J, class A, class F, class... Fs>
+    struct first_applicable<J, A, F, Fs...>
+      : first_applicable_if<is_applicable<F, A>::value, J, A, Fs...>
+    {};
+
+    template <std::size_t J, class A, class... Fs>
+    struct first_applicable_if<false, J, A, Fs...>
+      : first_applicable<J + 1, A, Fs...>
+    {};
+
+    //A type only a default handler (one that may be applied to
+    //anything, like `[](otherwise) {...}`) accepts
+    struct any_case {};
+
+    //The arguments a default handler accepts in place of an `A`
+    template <class A>
+    struct any_arguments {
+      using type = any_case&;
+    };
+
+    template <class... As>
+    struct any_arguments<arguments<As...>> {
+      using type = arguments<typename any_arguments<As>::type...>;
+    };
+
+    //`j` is one of `h[0]`, ..., `h[n - 1]`
+    constexpr bool contains (
+      std::size_t const* h, std::size_t n, std::size_t j) {
+      return n != 0 && (h[n - 1] == j || contains (h, n - 1, j));
+    }
+
+    //Each of the first `m` handlers is the handler of a case (one of
+    //`h[0]`, ..., `h[n - 1]`) or a default
+    constexpr bool all_applied (
+      std::size_t const* h, std::size_t n, bool const* d, std::size_t m) {
+      return m == 0 ||
+        ((d[m - 1] || contains (h, n, m - 1)) && all_applied (h, n, d, m - 1));
+    }
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief The index of the first of the handlers `Fs...` that may
+  //! be applied to an argument of type `A`
+  //!
+  //! \tparam A The type of the argument (`T&` or `T const&`)
+  //! \tparam Fs The handlers
+  //!
+  //! The handlers after the first that may be applied are not tested.
+  template <class A, class... Fs>
+  struct handler_index {
+    //! \brief The index (`no_handler` if no handler may be applied)
+    static constexpr std::size_t value =
+      detail::first_applicable<0, A, Fs...>::value;
+  };
+
+  //! \brief Primary template
+  template <class As, class... Fs>
+  struct match_table;
+
+  //! \brief The handler of each case of a `match`
+  //!
+  //! The handler of a case is the first of `Fs...` that may be applied
+  //! to it. The table is computed once for a set of handlers (the
+  //! handlers are tested against a case up to the first that may be
+  //! applied to it) and is what `match` dispatches through.
+  //!
+  //! \tparam As The types of the arguments of the handlers, one per
+  //! case (`T&` or `T const&`, or `detail::arguments<>` of those for a
+  //! match on several sums, one per combination of cases)
+  //! \tparam Fs The handlers
+  template <class... As, class... Fs>
+  struct match_table<std::tuple<As...>, Fs...> {
+    //! \brief The index of the handler of each case (`no_handler` if
+    //! there is none)
+    static constexpr std::size_t handler[] = {
+      handler_index<As, Fs...>::value..., no_handler
+    };
+
+    //! \cond
+    static constexpr bool is_default[] = {
+      detail::is_applicable<Fs, typename detail::any_arguments<
+        typename std::tuple_element<0, std::tuple<As...>>::type>::type
+      >::value..., false
+    };
+    //! \endcond
+
+    //! \brief Every case has a handler
+    static constexpr bool exhaustive =
+      !detail::contains (handler, sizeof... (As), no_handler);
+
+    //! \brief Every handler is the handler of a case (defaults, that
+    //! may be applied to anything, excepted)
+    static constexpr bool irredundant =
+      detail::all_applied (
+        handler, sizeof... (As), is_default, sizeof... (Fs));
+  };
+
+  //! \cond
+  template <class A, class... Fs>
+  constexpr std::size_t handler_index<A, Fs...>::value;
+
+  template <class... As, class... Fs>
+  constexpr std::size_t match_table<std::tuple<As...>, Fs...>::handler[];
+
+  template <class... As, class... Fs>
+  constexpr bool match_table<std::tuple<As...>, Fs...>::is_default[];
+
+  template <class... As, class... Fs>
+  constexpr bool match_table<std::tuple<As...>, Fs...>::exhaustive;
+
+  template <class... As, class... Fs>
+  constexpr bool match_table<std::tuple<As...>, Fs...>::irredundant;
+  //! \endcond
+
+}//namespace pgs
+
+#endif //!defined (MATCH_TABLE_61D897A5_45AD_473F_9645_459F43A06FED_H)
@@ -0,0 +1,633 @@
+#if !defined (PATTERN_ACC21073_1A8F_4547_BFA0_766202A92AB3_H)
+#  define PATTERN_ACC21073_1A8F_4547_BFA0_766202A92AB3_H
+
+//! \file pattern.hpp
+//!
+//! \brief Nested patterns
+//!
+//! `match_rules (s, rules...)` applies to `s` the handler of the first
+//! of `rules...` whose pattern matches `s` (and whose guard, if it has
+//! one, holds). The patterns are
+//!
+//! - `case_of<T> (ps...)`, which matches a sum whose active case is a
+//!   `T` whose fields (see `pattern_fields<>`) match `ps...` (any
+//!   fields if there are no `ps...`) and
+//! - `var`, which matches anything.
+//!
+//! Each `case_of` and `var` of a pattern binds a value (the `T` or the
+//! value matched). The handler and the guard of a rule are passed them,
+//! as `const` references, in the order they appear in the pattern.
+//!
+//! The rules are compiled at compile time into a single decision
+//! tree : the active index of a sum (the value matched or a field of a
+//! case of it) is examined once at most, however many rules test it,
+//! by comparisons (rather than indirect calls) so that the whole tree
+//! may be inlined. A value that no rule matches (rules with a guard
+//! aside) or a rule that is never applied is a compile time error.
+
+#  include <pgs/logical.hpp>
+#  include <pgs/match.hpp>
+#  include <pgs/recursive_union.hpp>
+#  include <pgs/sum_type.hpp>
+
+#  include <cstddef>
+#  include <cstdlib>
+#  include <memory>
+#  include <tuple>
+#  include <type_traits>
+#  include <utility>
+
+namespace pgs {
+
+  //! \brief The fields of a `T` to which nested patterns apply
+  //!
+  //! By default a case has none : `case_of<T> ()` only tests the
+  //! case. Specialize this template to expose them : `get` returns a
+  //! `std::tuple<>` of `const` references (for example
+  //! `std::tie (t.l, t.r)`).
+  //!
+  //! \tparam T A case of a sum
+  template <class T>
+  struct pattern_fields {
+    //! \brief The fields of `t`
+    static std::tuple<> get (T const&) {
+      return std::tuple<> {};
+    }
+  };
+
+  //! \brief The type of a pattern matching a `T` whose fields match
+  //! `Ps...`
+  template <class T, class... Ps>
+  struct case_pattern {};
+
+  //! \brief The type of a pattern matching anything
+  struct var_pattern {};
+
+  //! \brief A pattern matching anything
+  constexpr var_pattern var{};
+
+  //! \brief A pattern matching a `T` whose fields match `ps...` (any
+  //! fields if `ps...` is empty)
+  template <class T, class... Ps>
+  constexpr case_pattern<T, Ps...> case_of (Ps const&...) {
+    return case_pattern<T, Ps...> {};
+  }
+
+  //! \cond
+  namespace detail {
+
+    //The guard of a rule without one
+    struct no_guard {
+      template <class... As>
+      constexpr bool operator () (As const&...) const {
+        return true;
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief A rule : a pattern `P`, a guard `G` and a handler `F`
+  template <class P, class G, class F>
+  struct rule_type {
+    using pattern_type = P; //!< The type of the pattern
+    using guard_type = G; //!< The type of the guard
+
+    G guard; //!< The guard
+    F handler; //!< The handler
+  };
+
+  //! \brief A rule applying `f` to what `p` matches
+  template <class P, class F>
+  rule_type<P, detail::no_guard, decay_t<F>> rule (P const&, F&& f) {
+    return {detail::no_guard{}, std::forward<F>(f)};
+  }
+
+  //! \brief A rule applying `f` to what `p` matches if `g` holds for it
+  template <class P, class G, class F>
+  rule_type<P, decay_t<G>, decay_t<F>> rule (P const&, G&& g, F&& f) {
+    return {std::forward<G>(g), std::forward<F>(f)};
+  }
+
+  //! \cond
+  namespace detail {
+
+    template <class...>
+    struct type_list {};
+
+    template <class... Ls>
+    struct concat;
+
+    template <>
+    struct concat<> {
+      using type = type_list<>;
+    };
+
+    template <class... As>
+    struct concat<type_list<As...>> {
+      using type = type_list<As...>;
+    };
+
+    template <class... As, class... Bs, class... Ls>
+    struct concat<type_list<As...>, type_list<Bs...>, Ls...>
+      : concat<type_list<As..., Bs...>, Ls...>
+    {};
+
+    template <class L>
+    struct list_size;
+
+    template <class... Ts>
+    struct list_size<type_list<Ts...>>
+      : std::integral_constant<std::size_t, sizeof... (Ts)>
+    {};
+
+    template <std::size_t K, class L>
+    struct list_at;
+
+    template <std::size_t K, class... Ts>
+    struct list_at<K, type_list<Ts...>>
+      : std::tuple_element<K, std::tuple<Ts...>>
+    {};
+
+    template <std::size_t K, class L>
+    struct remove_at;
+
+    template <class T, class... Ts>
+    struct remove_at<0, type_list<T, Ts...>> {
+      using type = type_list<Ts...>;
+    };
+
+    template <std::size_t K, class T, class... Ts>
+    struct remove_at<K, type_list<T, Ts...>> {
+      using type = typename concat<
+        type_list<T>, typename remove_at<K - 1, type_list<Ts...>>::type
+      >::type;
+    };
+
+    template <std::size_t N, class T>
+    struct repeat {
+      using type = typename concat<
+        type_list<T>, typename repeat<N - 1, T>::type>::type;
+    };
+
+    template <class T>
+    struct repeat<0, T> {
+      using type = type_list<>;
+    };
+
+    template <class A, class B>
+    struct join_ranges;
+
+    template <std::size_t... As, std::size_t... Bs>
+    struct join_ranges<range<As...>, range<Bs...>> {
+      using type = range<As..., Bs...>;
+    };
+
+    //The pointers to values of the types of a list
+    template <class L>
+    struct pointers;
+
+    template <class... Ts>
+    struct pointers<type_list<Ts...>> {
+      using type = std::tuple<Ts const*...>;
+    };
+
+    //The fields of a `T` (a `std::tuple<>` of `const` references)
+    template <class T>
+    using fields_of =
+      decay_t<decltype (pattern_fields<T>::get (std::declval<T const&> ()))>;
+
+    template <class Fs>
+    struct field_types;
+
+    template <class... Fs>
+    struct field_types<std::tuple<Fs...>> {
+      using type = type_list<decay_t<Fs>...>;
+    };
+
+    //A pattern whose nodes are numbered (in pre-order : the position
+    //of the value they bind among the arguments of the handler). The
+    //patterns standing for the fields of a `case_of<T> ()` bind nothing
+    constexpr std::size_t no_slot = static_cast<std::size_t> (-1);
+
+    template <std::size_t S>
+    struct slot_var {};
+
+    template <std::size_t S, class T, class Subs>
+    struct slot_case {};
+
+    template <std::size_t S, class P>
+    struct number;
+
+    template <std::size_t S, class L>
+    struct number_list;
+
+    template <std::size_t S>
+    struct number<S, var_pattern> {
+      using type = slot_var<S>;
+      static constexpr std::size_t size = 1;
+    };
+
+    template <std::size_t S>
+    struct number<S, slot_var<no_slot>> {
+      using type = slot_var<no_slot>;
+      static constexpr std::size_t size = 0;
+    };
+
+    template <std::size_t S, class T, class... Ps>
+    struct number<S, case_pattern<T, Ps...>> {
+      static constexpr std::size_t arity =
+        std::tuple_size<fields_of<T>>::value;
+      static_assert (sizeof... (Ps) == 0 || sizeof... (Ps) == arity
+        , "pgs::case_of : the number of patterns is not the number of "
+          "fields of the case (see `pattern_fields<>`)");
+
+      using subs = number_list<S + 1, typename std::conditional<
+          sizeof... (Ps) == 0
+        , typename repeat<arity, slot_var<no_slot>>::type
+        , type_list<Ps...>>::type>;
+
+      using type = slot_case<S, T, typename subs::type>;
+      static constexpr std::size_t size = 1 + subs::size;
+    };
+
+    template <std::size_t S>
+    struct number_list<S, type_list<>> {
+      using type = type_list<>;
+      static constexpr std::size_t size = 0;
+    };
+
+    template <std::size_t S, class P, class... Ps>
+    struct number_list<S, type_list<P, Ps...>> {
+      using head = number<S, P>;
+      using tail = number_list<S + head::size, type_list<Ps...>>;
+
+      using type = typename concat<
+        type_list<typename head::type>, typename tail::type>::type;
+      static constexpr std::size_t size = head::size + tail::size;
+    };
+
+    //A row of the decision : what is left to match of rule `H`. `Cols`
+    //are the patterns the values under examination are to match (one
+    //each), `Bound` the positions (`bound<S, E>`) in the values
+    //examined already of the values bound by the nodes numbered `S`
+    template <std::size_t H, class Bound, class Cols>
+    struct row {};
+
+    template <std::size_t S, std::size_t E>
+    struct bound {};
+
+    //The column of the first `case_of` of a row (`no_slot` if none)
+    template <std::size_t K, class Cols>
+    struct first_case_column : std::integral_constant<std::size_t, no_slot>
+    {};
+
+    template <std::size_t K, std::size_t S, class... Cs>
+    struct first_case_column<K, type_list<slot_var<S>, Cs...>>
+      : first_case_column<K + 1, type_list<Cs...>>
+    {};
+
+    template <std::size_t K, std::size_t S, class T, class Subs, class... Cs>
+    struct first_case_column<K, type_list<slot_case<S, T, Subs>, Cs...>>
+      : std::integral_constant<std::size_t, K>
+    {};
+
+    //The row of rule `H` if the value of its column `Col` is a `C`
+    //(with `N` fields, the sum being examined value `E`, the `C` value
+    //`E + 1`). `Rest` are the other columns
+    template <class Col, std::size_t H, class Bound, class Rest
+            , class C, std::size_t N, std::size_t E>
+    struct specialize_column;
+
+    template <std::size_t S, std::size_t H, class Bound, class Rest
+            , class C, std::size_t N, std::size_t E>
+    struct specialize_column<slot_var<S>, H, Bound, Rest, C, N, E> {
+      using type = type_list<row<H
+        , typename std::conditional<S == no_slot
+            , Bound
+            , typename concat<Bound, type_list<bound<S, E>>>::type>::type
+        , typename concat<
+            typename repeat<N, slot_var<no_slot>>::type, Rest>::type>>;
+    };
+
+    template <std::size_t S, class T, class Subs, std::size_t H, class Bound
+            , class Rest, class C, std::size_t N, std::size_t E>
+    struct specialize_column<slot_case<S, T, Subs>, H, Bound, Rest, C, N, E> {
+      using type = typename std::conditional<std::is_same<T, C>::value
+        , type_list<row<H
+            , typename concat<Bound, type_list<bound<S, E + 1>>>::type
+            , typename concat<Subs, Rest>::type>>
+        , type_list<>>::type;
+    };
+
+    template <class Row, std::size_t K, class C, std::size_t N, std::size_t E>
+    struct specialize;
+
+    template <std::size_t H, class Bound, class Cols
+            , std::size_t K, class C, std::size_t N, std::size_t E>
+    struct specialize<row<H, Bound, Cols>, K, C, N, E>
+      : specialize_column<typename list_at<K, Cols>::type
+        , H, Bound, typename remove_at<K, Cols>::type, C, N, E>
+    {};
+
+    template <class Rows, std::size_t K, class C, std::size_t N, std::size_t E>
+    struct specialize_rows;
+
+    template <class... Rows, std::size_t K, class C, std::size_t N, std::size_t E>
+    struct specialize_rows<type_list<Rows...>, K, C, N, E>
+      : concat<typename specialize<Rows, K, C, N, E>::type...>
+    {};
+
+    //The value bound by the node `S` of a pattern : the `E`th value
+    //examined or the value of column `K`
+    template <std::size_t S, class Bound>
+    struct find_bound : std::integral_constant<std::size_t, no_slot>
+    {};
+
+    template <std::size_t S, std::size_t T, std::size_t E, class... Bs>
+    struct find_bound<S, type_list<bound<T, E>, Bs...>>
+      : std::integral_constant<std::size_t,
+          S == T ? E : find_bound<S, type_list<Bs...>>::value>
+    {};
+
+    template <std::size_t S, std::size_t K, class Cols>
+    struct find_var : std::integral_constant<std::size_t, no_slot>
+    {};
+
+    template <std::size_t S, std::size_t K, class C, class... Cs>
+    struct find_var<S, K, type_list<C, Cs...>>
+      : std::integral_constant<std::size_t,
+          std::is_same<C, slot_var<S>>::value
+            ? K
+            : find_var<S, K + 1, type_list<Cs...>>::value>
+    {};
+
+    template <bool Examined, std::size_t I>
+    struct fetch {
+      template <class O, class E>
+      static auto get (O const&, E const& e) -> decltype (*std::get<I> (e)) {
+        return *std::get<I> (e);
+      }
+    };
+
+    template <std::size_t I>
+    struct fetch<false, I> {
+      template <class O, class E>
+      static auto get (O const& o, E const&) -> decltype (*std::get<I> (o)) {
+        return *std::get<I> (o);
+      }
+    };
+
+    template <std::size_t S, class Bound, class Cols>
+    using fetch_slot = fetch<
+        find_bound<S, Bound>::value != no_slot
+      , find_bound<S, Bound>::value != no_slot
+          ? find_bound<S, Bound>::value
+          : find_var<S, 0, Cols>::value>;
+
+    //The decision on values of types `Occs` (the values examined
+    //already, `Env`) among the rows `Rows` (of the rules `Rules`, a
+    //`std::tuple<>` of references)
+    template <class R, class Rules, class Occs, class Env, class Rows>
+    struct decision;
+
+    template <bool Reached, class D, std::size_t H>
+    struct lazy_uses : std::false_type
+    {};
+
+    template <class D, std::size_t H>
+    struct lazy_uses<true, D, H> : D::template uses<H>
+    {};
+
+    //No row : the values are matched by no rule
+    template <class R, class Rules, class Occs, class Env>
+    struct decision<R, Rules, Occs, Env, type_list<>> {
+      template <std::size_t H>
+      struct uses : std::false_type
+      {};
+
+      static R run (
+          typename pointers<Occs>::type const&
+        , typename pointers<Env>::type const&
+        , Rules const&) {
+        static_assert (sizeof (Occs*) == 0
+          , "pgs::match_rules : a value is matched by no rule (without a "
+            "guard)");
+        std::abort ();
+      }
+    };
+
+    template <class R, class Rules, class Occs, class Env
+            , class Row, class Rest, std::size_t K>
+    struct decision_node;
+
+    template <class R, class Rules, class Occs, class Env
+            , std::size_t H, class Bound, class Cols, class... Rows>
+    struct decision<R, Rules, Occs, Env
+                  , type_list<row<H, Bound, Cols>, Rows...>>
+      : decision_node<R, Rules, Occs, Env
+                    , row<H, Bound, Cols>, type_list<Rows...>
+                    , first_case_column<0, Cols>::value>
+    {};
+
+    //The first row matches anything : apply its rule (if its guard
+    //holds, else decide among the other rows)
+    template <class R, class Rules, class Occs, class Env
+            , std::size_t H, class Bound, class Cols, class Rest>
+    struct decision_node<R, Rules, Occs, Env
+                       , row<H, Bound, Cols>, Rest, no_slot> {
+      using rule = decay_t<typename std::tuple_element<H, Rules>::type>;
+      using rest = decision<R, Rules, Occs, Env, Rest>;
+      using occ_ptrs = typename pointers<Occs>::type;
+      using env_ptrs = typename pointers<Env>::type;
+
+      static constexpr bool guarded =
+        !std::is_same<typename rule::guard_type, no_guard>::value;
+
+      template <std::size_t G>
+      struct uses
+        : std::integral_constant<bool,
+            G == H || lazy_uses<guarded, rest, G>::value>
+      {};
+
+      static R run (occ_ptrs const& o, env_ptrs const& e, Rules const& rules) {
+        return apply (o, e, rules
+          , typename index_span<
+              0, number<0, typename rule::pattern_type>::size>::type {}
+          , std::integral_constant<bool, guarded> {});
+      }
+
+    private:
+      template <std::size_t... Ss>
+      static R apply (occ_ptrs const& o, env_ptrs const& e, Rules const& rules
+                    , range<Ss...>, std::false_type) {
+        return handler_invoke<R>::apply (std::get<H> (rules).handler
+          , fetch_slot<Ss, Bound, Cols>::get (o, e)...);
+      }
+
+      template <std::size_t... Ss>
+      static R apply (occ_ptrs const& o, env_ptrs const& e, Rules const& rules
+                    , range<Ss...>, std::true_type) {
+        return std::get<H> (rules).guard (
+            fetch_slot<Ss, Bound, Cols>::get (o, e)...)
+          ? handler_invoke<R>::apply (std::get<H> (rules).handler
+              , fetch_slot<Ss, Bound, Cols>::get (o, e)...)
+          : rest::run (o, e, rules);
+      }
+    };
+
+    //The first row has a `case_of` in column `K` : examine the sum
+    //there, once, and decide for its active case among the rows that
+    //admit it (with the fields of the case in place of the sum)
+    template <class R, class Rules, class Occs, class Env
+            , class Row, class Rest, std::size_t K>
+    struct decision_node {
+      using rows = typename concat<type_list<Row>, Rest>::type;
+      using sum = typename list_at<K, Occs>::type;
+      using occ_ptrs = typename pointers<Occs>::type;
+      using env_ptrs = typename pointers<Env>::type;
+
+      static_assert (is_sum_type<sum>::value
+        , "pgs::case_of : the value matched is not a sum");
+
+      template <std::size_t I>
+      struct branch {
+        using case_type = decay_t<decltype (union_ref<I> (
+          sum_type_accessor::storage (std::declval<sum const&> ())))>;
+        using fields = fields_of<case_type>;
+
+        using next = decision<R, Rules
+          , typename concat<typename field_types<fields>::type
+                          , typename remove_at<K, Occs>::type>::type
+          , typename concat<Env, type_list<sum, case_type>>::type
+          , typename specialize_rows<rows, K, case_type
+              , std::tuple_size<fields>::value
+              , list_size<Env>::value>::type>;
+
+        static R run (
+          occ_ptrs const& o, env_ptrs const& e, Rules const& rules) {
+          sum const& s = *std::get<K> (o);
+          case_type const& c = union_ref<I> (sum_type_accessor::storage (s));
+          fields const f = pattern_fields<case_type>::get (c);
+
+          return step (o, e, rules, s, c, f
+            , typename index_span<0, std::tuple_size<fields>::value>::type {}
+            , typename join_ranges<
+                  typename index_span<0, K>::type
+                , typename index_span<K + 1, list_size<Occs>::value>::type
+              >::type {}
+            , typename index_span<0, list_size<Env>::value>::type {});
+        }
+
+      private:
+        template <std::size_t... Fs, std::size_t... Ks, std::size_t... Es>
+        static R step (occ_ptrs const& o, env_ptrs const& e, Rules const& rules
+                     , sum const& s, case_type const& c, fields const& f
+                     , range<Fs...>, range<Ks...>, range<Es...>) {
+          return next::run (
+              typename pointers<typename concat<
+                  typename field_types<fields>::type
+                , typename remove_at<K, Occs>::type>::type>::type (
+                std::addressof (std::get<Fs> (f))..., std::get<Ks> (o)...)
+            , typename pointers<typename concat<
+                  Env, type_list<sum, case_type>>::type>::type (
+                std::get<Es> (e)..., std::addressof (s), std::addressof (c))
+            , rules);
+        }
+      };
+
+      template <class Is>
+      struct on_cases;
+
+      template <std::size_t... Is>
+      struct on_cases<range<Is...>> {
+        template <std::size_t G>
+        struct uses : or_<typename branch<Is>::next::template uses<G>...>
+        {};
+      };
+
+      //Select the branch of the active index `i` among `[Lo, Hi)` by
+      //halving the range : comparisons the compiler may fold into the
+      //branches (an indirect call per node would keep it from inlining
+      //the decision tree)
+      template <std::size_t Lo, std::size_t Hi, bool = Hi - Lo == 1>
+      struct select {
+        static R run (std::size_t i
+                    , occ_ptrs const& o, env_ptrs const& e, Rules const& rules) {
+          return i < (Lo + Hi) / 2
+            ? select<Lo, (Lo + Hi) / 2>::run (i, o, e, rules)
+            : select<(Lo + Hi) / 2, Hi>::run (i, o, e, rules);
+        }
+      };
+
+      template <std::size_t Lo, std::size_t Hi>
+      struct select<Lo, Hi, true> {
+        static R run (std::size_t
+                    , occ_ptrs const& o, env_ptrs const& e, Rules const& rules) {
+          return branch<Lo>::run (o, e, rules);
+        }
+      };
+
+      using cases =
+        on_cases<typename index_span<0, sum_type_size<sum>::value>::type>;
+
+      template <std::size_t G>
+      struct uses : cases::template uses<G>
+      {};
+
+      static R run (occ_ptrs const& o, env_ptrs const& e, Rules const& rules) {
+        return select<0, sum_type_size<sum>::value>::run (
+          sum_type_accessor::active_index (*std::get<K> (o)), o, e, rules);
+      }
+    };
+
+    template <class R, class S, class Hs, class... Rules>
+    struct rules_matcher;
+
+    template <class R, class S, std::size_t... Hs, class... Rules>
+    struct rules_matcher<R, S, range<Hs...>, Rules...> {
+      using rules_type = std::tuple<Rules const&...>;
+
+      using tree = decision<R, rules_type, type_list<S>, type_list<>
+        , type_list<row<Hs, type_list<>, type_list<typename number<
+            0, typename Rules::pattern_type>::type>>...>>;
+
+      static_assert (and_<typename tree::template uses<Hs>...>::value
+        , "pgs::match_rules : a rule is never applied (the rules before it "
+          "match everything it does)");
+
+      static R run (S const& s, Rules const&... rules) {
+        return tree::run (
+          std::tuple<S const*> (std::addressof (s)), std::tuple<> ()
+        , rules_type (rules...));
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief Apply to `s` the handler of the first of `rules...` that
+  //! matches it (see `rule ()`)
+  //!
+  //! \returns The result of the handler
+  template <class R, class S, class... Rules>
+  R match_rules (S const& s, Rules const&... rules) {
+    return detail::rules_matcher<R, S
+      , typename detail::index_span<0, sizeof... (Rules)>::type
+      , Rules...>::run (s, rules...);
+  }
+
+  //! \brief `match_rules` procedure (see `match_rules<R>`)
+  //!
+  //! (The leading parameter stands in the way of `match_rules<R>`, that
+  //! would otherwise name this function with `S` being `R`)
+  template <int = 0, class S, class... Rules>
+  void match_rules (S const& s, Rules const&... rules) {
+    detail::rules_matcher<void, S
+      , typename detail::index_span<0, sizeof... (Rules)>::type
+      , Rules...>::run (s, rules...);
+  }
+
+}//namespace pgs
+
+#endif //!defined (PATTERN_ACC21073_1A8F_4547_BFA0_766202A92AB3_H)
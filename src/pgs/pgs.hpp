@@ -2,5 +2,10 @@
 #  define C7B3E27A_AEEB_4AE2_A321_9B322110D2AA
 
 #  include <pgs/sum_type.hpp>
+#  include <pgs/match.hpp>
+#  include <pgs/pattern.hpp>
+#  include <pgs/arena.hpp>
+#  include <pgs/pool.hpp>
+#  include <pgs/hash_cons.hpp>
 
 #endif //!defined(C7B3E27A_AEEB_4AE2_A321_9B322110D2AA)
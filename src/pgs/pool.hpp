@@ -0,0 +1,312 @@
+#if !defined (POOL_D3A61F08_5B2E_4C97_8E14_A07C9B2D6F51_H)
+#  define POOL_D3A61F08_5B2E_4C97_8E14_A07C9B2D6F51_H
+
+//! \file pool.hpp
+//!
+//! \brief A per-type, per-thread free list of nodes and an allocator
+//! drawing from it
+//!
+//! The nodes of a recursive type (the cons cells of a list, the nodes
+//! of a tree) are all of one size and are allocated and freed at a
+//! high rate. `pool_allocator<T>` (as the allocator of
+//! `recursive_wrapper<T, A>`) serves them from slabs of contiguous
+//! nodes, recycling freed nodes through a free list without going
+//! back to the global allocator.
+
+#  include <pgs/recursive_wrapper.hpp>
+
+#  include <atomic>
+#  include <cstddef>
+#  include <mutex>
+#  include <new>
+#  include <type_traits>
+
+namespace pgs {
+
+  //! \brief Statistics of the pool of a type (for the calling thread,
+  //! including the history of a pool it took over)
+  struct pool_stats {
+    std::size_t live; //!< Nodes allocated and not yet freed
+    std::size_t slabs; //!< Slabs obtained from the global allocator
+    std::size_t hits; //!< Allocations served by a recycled node
+    std::size_t misses; //!< Allocations served by a fresh node
+
+    //! \brief The proportion of allocations served by recycled nodes
+    double hit_rate () const noexcept {
+      return hits + misses == 0
+        ? 0.0 : static_cast<double>(hits) / (hits + misses);
+    }
+  };
+
+  //! \cond
+  namespace detail {
+
+    //`n` rounded up to the alignment of `operator new`
+    constexpr std::size_t pool_round (std::size_t n) {
+      return (n + alignof (std::max_align_t) - 1)
+        / alignof (std::max_align_t) * alignof (std::max_align_t);
+    }
+
+    //The nodes of type `T` of one thread, carved from slabs and
+    //recycled through a free list. Nodes are aligned as `operator new`
+    //aligns (so that the low bits of their addresses are available to
+    //`tagged_pointer_union<>`) and each is preceded by a header naming
+    //the pool it was carved from : a node freed by the owning thread
+    //goes on the free list, one freed by any other thread on the
+    //owner's remote list (a lock-free stack the owner takes over,
+    //whole, when its free list runs dry).
+    //
+    //A pool whose thread exits with nodes still in use is orphaned : it
+    //goes on taking frees and is adopted by the next thread to
+    //allocate a `T`. Slabs are returned only when no node is
+    //outstanding.
+    template <class T>
+    class node_pool {
+    private:
+      struct free_node {
+        free_node* next;
+      };
+      struct slab {
+        slab* next;
+      };
+
+      static constexpr std::size_t header_size = pool_round (sizeof (node_pool*));
+      static constexpr std::size_t node_size = header_size + pool_round (
+        sizeof (T) > sizeof (free_node) ? sizeof (T) : sizeof (free_node));
+      static constexpr std::size_t slab_header_size = pool_round (sizeof (slab));
+
+      free_node* free_;
+      std::atomic<free_node*> remote_;
+      slab* slabs_;
+      char* cur_;
+      char* end_;
+      pool_stats stats_;
+      node_pool* next_orphan_;
+
+      node_pool () noexcept
+        : free_ {nullptr}, remote_ {nullptr}, slabs_ {nullptr}
+        , cur_ {nullptr}, end_ {nullptr}, stats_ {0, 0, 0, 0}
+        , next_orphan_ {nullptr}
+      {}
+
+      ~node_pool () {
+        while (slabs_ != nullptr) {
+          slab* next = slabs_->next;
+          ::operator delete (slabs_);
+          slabs_ = next;
+        }
+      }
+
+      //Ties a pool to the calling thread for the thread's lifetime
+      struct owner {
+        node_pool* pool;
+
+        owner () : pool {adopt ()} {
+          current () = pool;
+        }
+
+        ~owner () {
+          current () = nullptr;
+          pool->release ();
+        }
+      };
+
+      //The pool owned by the calling thread (`nullptr` if none)
+      static node_pool*& current () noexcept {
+        static thread_local node_pool* pool = nullptr;
+        return pool;
+      }
+
+      static std::mutex& orphans_mutex () {
+        static std::mutex mutex;
+        return mutex;
+      }
+
+      static node_pool*& orphans () {
+        static node_pool* orphans = nullptr;
+        return orphans;
+      }
+
+      static node_pool* adopt () {
+        {
+          std::lock_guard<std::mutex> lock {orphans_mutex ()};
+          node_pool*& o = orphans ();
+          if (o != nullptr) {
+            node_pool* p = o;
+            o = p->next_orphan_;
+            return p;
+          }
+        }
+        return new node_pool;
+      }
+
+      void release () {
+        collect ();
+        if (stats_.live == 0) {
+          delete this; //no node is outstanding, nor can one be freed
+          return;
+        }
+        std::lock_guard<std::mutex> lock {orphans_mutex ()};
+        next_orphan_ = orphans ();
+        orphans () = this;
+      }
+
+      //Take over the nodes freed by other threads
+      void collect () noexcept {
+        if (remote_.load (std::memory_order_relaxed) == nullptr)
+          return;
+        free_node* n = remote_.exchange (nullptr, std::memory_order_acquire);
+        free_node* last = n;
+        for (--stats_.live; last->next != nullptr; --stats_.live)
+          last = last->next;
+        last->next = free_;
+        free_ = n;
+      }
+
+    public:
+      //The number of nodes carved from each slab
+      static constexpr std::size_t nodes_per_slab = 256;
+
+      node_pool (node_pool const&) = delete;
+      node_pool& operator= (node_pool const&) = delete;
+
+      static node_pool& instance () {
+        node_pool* pool = current ();
+        if (pool == nullptr) {
+          static thread_local owner o;
+          pool = o.pool;
+        }
+        return *pool;
+      }
+
+      void* allocate () {
+        if (free_ == nullptr)
+          collect ();
+        ++stats_.live;
+        if (free_ != nullptr) {
+          ++stats_.hits;
+          free_node* n = free_;
+          free_ = n->next;
+          return n;
+        }
+        ++stats_.misses;
+        if (cur_ == end_) {
+          slab* s = static_cast<slab*>(
+            ::operator new (slab_header_size + nodes_per_slab * node_size));
+          s->next = slabs_;
+          slabs_ = s;
+          ++stats_.slabs;
+          cur_ = reinterpret_cast<char*>(s) + slab_header_size;
+          end_ = cur_ + nodes_per_slab * node_size;
+        }
+        char* p = cur_;
+        cur_ += node_size;
+        *reinterpret_cast<node_pool**>(p) = this;
+        return p + header_size;
+      }
+
+      //Return `p` to the pool it was carved from (from any thread)
+      static void deallocate (void* p) noexcept {
+        node_pool* pool = *reinterpret_cast<node_pool**>(
+          static_cast<char*>(p) - header_size);
+        free_node* n = static_cast<free_node*>(p);
+        if (pool == current ()) {
+          --pool->stats_.live;
+          n->next = pool->free_;
+          pool->free_ = n;
+          return;
+        }
+        free_node* head = pool->remote_.load (std::memory_order_relaxed);
+        do
+          n->next = head;
+        while (!pool->remote_.compare_exchange_weak (
+          head, n, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      pool_stats const& stats () noexcept {
+        collect ();
+        return stats_;
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \class pool_allocator
+  //!
+  //! \brief An allocator serving single objects of type `T` from a
+  //! free list of the calling thread
+  //!
+  //! Requests for more than one object are passed on to the global
+  //! allocator. `pool_allocator<>` is stateless : a sum whose boxed
+  //! cases use it keeps the tagged pointer representation.
+  //!
+  //! Threads : an object may be freed by any thread, not only the one
+  //! that allocated it. It is handed back (through a lock-free list)
+  //! to the pool of the allocating thread, which recycles it at its
+  //! next allocation; the freeing thread's own pool is not touched.
+  //! A thread may exit while objects it allocated are still in use :
+  //! its pool stays alive until they are freed and is taken over by
+  //! the next thread to allocate a `T`. Memory goes back to the global
+  //! allocator only from a pool with no objects outstanding, so a
+  //! pool is as large as the most objects it ever had live at once.
+  //!
+  //! \tparam T The type of object allocated
+  template <class T>
+  struct pool_allocator {
+    using value_type = T; //!< The type of object allocated
+
+    //! \brief Default ctor
+    pool_allocator () noexcept
+    {}
+
+    //! \brief Converting ctor
+    template <class U>
+    pool_allocator (pool_allocator<U> const&) noexcept
+    {}
+
+    //! \brief Allocate storage for `n` objects of type `T`
+    T* allocate (std::size_t n) {
+      static_assert (alignof (T) <= alignof (std::max_align_t)
+        , "over-aligned types are not supported");
+      if (n == 1)
+        return static_cast<T*>(detail::node_pool<T>::instance ().allocate ());
+      return static_cast<T*>(::operator new (n * sizeof (T)));
+    }
+
+    //! \brief Free storage for `n` objects of type `T`
+    void deallocate (T* p, std::size_t n) noexcept {
+      if (n == 1)
+        detail::node_pool<T>::deallocate (p);
+      else
+        ::operator delete (p);
+    }
+
+    //! \brief The statistics of the pool of `T` for the calling
+    //! thread (counting objects freed by other threads as freed)
+    static pool_stats stats () {
+      return detail::node_pool<T>::instance ().stats ();
+    }
+  };
+
+  //! \brief Partial specialization for pool allocators (their nodes
+  //! are aligned as `operator new` aligns)
+  template <class T>
+  struct is_max_aligned_allocator<pool_allocator<T>> : std::true_type
+  {};
+
+  //! \brief `true` (pool allocators are interchangeable)
+  template <class T, class U>
+  bool operator== (pool_allocator<T> const&, pool_allocator<U> const&) {
+    return true;
+  }
+
+  //! \brief `false` (pool allocators are interchangeable)
+  template <class T, class U>
+  bool operator!= (pool_allocator<T> const&, pool_allocator<U> const&) {
+    return false;
+  }
+
+}//namespace pgs
+
+#endif //!defined (POOL_D3A61F08_5B2E_4C97_8E14_A07C9B2D6F51_H)
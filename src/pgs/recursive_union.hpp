@@ -8,11 +8,21 @@
 //! The recursive union datatype here is designed to serve as the
 //! implementation mechanism of the sum type.
 
+#  include <pgs/config.hpp>
+#  include <pgs/hash.hpp>
 #  include <pgs/logical.hpp>
+#  include <pgs/match_table.hpp>
 #  include <pgs/recursive_wrapper.hpp>
+#  include <pgs/shared_recursive_wrapper.hpp>
 #  include <pgs/type_traits.hpp>
 
+#  include <atomic>
+#  include <cstddef>
+#  include <cstdio>
+#  include <cstdlib>
 #  include <stdexcept>
+#  include <string>
+#  include <tuple>
 #  include <type_traits>
 #  include <iostream>
 
@@ -27,6 +37,163 @@ namespace pgs {
   //! \brief A type to model an overload
   template <class T> struct overload_tag {};
 
+  //! \cond
+  namespace detail {
+
+    template <std::size_t I, class T, class... Ts>
+    struct index_of_impl;
+
+    template <std::size_t I, class T, class... Ts>
+    struct index_of_impl<I, T, T, Ts...> {
+      static auto const value = I;
+    };
+
+    template <std::size_t I, class T, class A, class... Ts>
+    struct index_of_impl<I, T, recursive_wrapper<T, A>, Ts...> {
+      static auto const value = I;
+    };
+
+    template <std::size_t I, class T, class C, class... Ts>
+    struct index_of_impl<I, T, shared_recursive_wrapper<T, C>, Ts...> {
+      static auto const value = I;
+    };
+
+    template <std::size_t I, class X, class T, class... Ts>
+    struct index_of_impl<I, X, T, Ts...>{
+      static auto const value = index_of_impl<I + 1, X, Ts...>::value;
+    };
+
+    //A case whose node may be shared with other values (or referred
+    //to by an intern table) : it is never moved from
+    template <class T>
+    struct is_shared_case : std::false_type
+    {};
+
+    template <class T, class C>
+    struct is_shared_case<shared_recursive_wrapper<T, C>> : std::true_type
+    {};
+
+    template <std::size_t I, class T, class... Ts>
+    struct type_at_impl : type_at_impl<I - 1, Ts...>
+    {};
+
+    template <class T, class... Ts>
+    struct type_at_impl<0, T, Ts...> {
+      using type = recursive_wrapper_unwrap_t<T>;
+    };
+
+    //Assignment between values of the same case `T` : by `T`'s own
+    //assignment or, if `T` has none, by destroying the value and
+    //constructing it anew
+    template <class T>
+    void case_assign (T& dst, T const& src, std::true_type) {
+      dst = src;
+    }
+
+    template <class T>
+    void case_assign (T& dst, T const& src, std::false_type) {
+      dst.~T ();
+      new (std::addressof (dst)) T (src);
+    }
+
+    template <class T>
+    void case_assign (T& dst, T const& src) {
+      case_assign (dst, src, std::is_copy_assignable<T>{});
+    }
+
+    template <class T>
+    void case_move_assign (T& dst, T&& src, std::true_type) {
+      dst = std::move (src);
+    }
+
+    template <class T>
+    void case_move_assign (T& dst, T&& src, std::false_type) {
+      dst.~T ();
+      new (std::addressof (dst)) T (std::move (src));
+    }
+
+    template <class T>
+    void case_move_assign (T& dst, T&& src) {
+      case_move_assign (dst, std::move (src), std::is_move_assignable<T>{});
+    }
+
+    //Whether the destruction of a case `T` is trivial (never so for a
+    //boxed case : this is decided without looking into the wrapper,
+    //the type of whose value may be incomplete)
+    template <class T>
+    struct is_trivially_destructible_case : std::is_trivially_destructible<T>
+    {};
+
+    template <class T, class A>
+    struct is_trivially_destructible_case<recursive_wrapper<T, A>>
+      : std::false_type
+    {};
+
+    template <class T, class C>
+    struct is_trivially_destructible_case<shared_recursive_wrapper<T, C>>
+      : std::false_type
+    {};
+
+    //Whether the copy, move, assignment and destruction of a case `T`
+    //are all trivial (never so for a boxed case)
+    template <class T>
+    struct is_trivially_copyable_case
+      : and_<
+            std::is_trivially_copy_constructible<T>
+          , std::is_trivially_move_constructible<T>
+          , std::is_trivially_copy_assignable<T>
+          , std::is_trivially_move_assignable<T>
+          , std::is_trivially_destructible<T>>
+    {};
+
+    template <class T, class A>
+    struct is_trivially_copyable_case<recursive_wrapper<T, A>>
+      : std::false_type
+    {};
+
+    template <class T, class C>
+    struct is_trivially_copyable_case<shared_recursive_wrapper<T, C>>
+      : std::false_type
+    {};
+
+    //Whether `case_move_assign` on values of type `T` can throw
+    template <class T>
+    struct is_nothrow_case_move_assignable
+      : std::integral_constant<bool, std::is_move_assignable<T>::value
+          ? std::is_nothrow_move_assignable<T>::value
+          : std::is_nothrow_move_constructible<T>::value>
+    {};
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief A metafunction to compute the index `I` of a type `T` in a
+  //! sequence `Ts`
+  //!
+  //! \tparam T The type for which we desire its index in `Ts`
+  //! \tparam Ts A parameter pack containing `T`
+  template <class T, class... Ts>
+  struct index_of {
+    //!\brief The index of `T` in `Ts...`
+    static constexpr auto const value =
+      detail::index_of_impl<0u, T, Ts...>::value;
+  };
+
+  //! \brief Get the type at a given index in a variadic type list
+  template <std::size_t I,  class... Ts>
+  using type_at = typename detail::type_at_impl<I, Ts...>::type;
+
+  //! \brief The reference to the value at a given index in a variadic
+  //! type list got from an rvalue : an rvalue reference (that may be
+  //! moved from) unless the type is a `shared_recursive_wrapper<>`
+  //! (whose node other values may share), then a `const` reference
+  template <std::size_t I,  class... Ts>
+  using rvalue_type_at = typename std::conditional<
+      detail::is_shared_case<
+        typename std::tuple_element<I, std::tuple<Ts...>>::type>::value
+    , type_at<I, Ts...> const&
+    , type_at<I, Ts...>&&>::type;
+
   //! \brief Dereference the value field in a
   //! `recursive_union<>`. This case handles values that are not
   //! `recursive_wrapper` instances.
@@ -146,6 +313,155 @@ namespace pgs {
     }
   };
 
+  //! \brief Produce a non-`const` reference to the `I`th value of a
+  //! `recursive_union<>` (the object referred to if that value is a
+  //! `recursive_wrapper<>`)
+  //!
+  //! Storage types other than `recursive_union<>` that can be used to
+  //! implement the sum type provide overloads of this function.
+  template <std::size_t I, class... Ts>
+  constexpr auto union_ref (recursive_union<Ts...>& u)
+    -> decltype (recursive_union_indexer<I, Ts...>::ref (u)) {
+    return recursive_union_indexer<I, Ts...>::ref (u);
+  }
+
+  //! \brief Produce a `const` reference to the `I`th value of a
+  //! `recursive_union<>` (the object referred to if that value is a
+  //! `recursive_wrapper<>`)
+  template <std::size_t I, class... Ts>
+  constexpr auto union_ref (recursive_union<Ts...> const& u)
+    -> decltype (recursive_union_indexer<I, Ts...>::ref (u)) {
+    return recursive_union_indexer<I, Ts...>::ref (u);
+  }
+
+  //! \brief Produce a pointer to the `I`th value of a
+  //! `recursive_union<>` (the object referred to if that value is a
+  //! `recursive_wrapper<>`, `nullptr` if that wrapper has been moved
+  //! from)
+  //!
+  //! Storage types other than `recursive_union<>` that can be used to
+  //! implement the sum type provide overloads of this function.
+  template <std::size_t I, class... Ts>
+  constexpr auto union_ptr (recursive_union<Ts...>& u)
+    -> decltype (recursive_union_indexer<I, Ts...>::ptr (u)) {
+    return recursive_union_indexer<I, Ts...>::ptr (u);
+  }
+
+  //! \class range
+  //!
+  //! \brief Compile time sequence of integers
+  template <std::size_t...> struct range {};
+
+  //! \cond
+  namespace detail {
+    template <std::size_t Z, std::size_t N, std::size_t... Ns>
+    struct mk_range  : mk_range <Z, N - 1, N, Ns...>
+    {};
+
+    template <std::size_t Z, std::size_t... Ns>
+    struct mk_range<Z, Z, Ns...> {
+      using type = range<Z, Ns...>;
+    };
+  }//namespace detail
+  //! \endcond
+
+  //! \brief Alias type for a range
+  template <std::size_t Z, std::size_t N>
+  using range_t =  typename detail::mk_range<Z, N>::type;
+
+  //! \cond
+  namespace detail {
+
+    //A parameter that is passed anything and ignored
+    template <std::size_t>
+    struct ignored {
+      template <class T>
+      constexpr ignored (T const&) {}
+    };
+
+    //The `J`th of a pack of handlers : `Is...` counts the handlers
+    //before it (the selection is a single deduction, not a recursion
+    //on `J`)
+    template <class Is>
+    struct nth_handler;
+
+    template <std::size_t... Is>
+    struct nth_handler<range<Is...>> {
+      template <class F, class... Fs>
+      static constexpr F&& get (ignored<Is>..., F&& f, Fs&&...) {
+        return std::forward<F>(f);
+      }
+    };
+
+    //The case at index `I` (as stored) of a storage or sum type `S`
+    template <std::size_t I, class S>
+    struct storage_case;
+
+    template <std::size_t I, template <class...> class S, class... Ts>
+    struct storage_case<I, S<Ts...>>
+      : std::tuple_element<I, std::tuple<Ts...>>
+    {};
+
+    //A reference to `t`, the case at index `I` of a storage of type
+    //`U` (as deduced for a forwarding reference) : an rvalue reference
+    //if the storage is an rvalue and the case is not shared, so that
+    //the case may be moved from
+    template <class U, std::size_t I, class T>
+    using case_reference = typename std::conditional<
+      std::is_lvalue_reference<U>::value, T&
+    , typename std::conditional<
+        is_shared_case<
+          typename storage_case<I, decay_t<U>>::type>::value
+      , T const&, T&&>::type>::type;
+
+    template <class U, std::size_t I, class T>
+    constexpr case_reference<U, I, T> forward_case (T& t) noexcept {
+      return static_cast<case_reference<U, I, T>> (t);
+    }
+
+    template <std::size_t J>
+    struct handler_position {
+      using type = range_t<1, J>;
+    };
+
+    template <>
+    struct handler_position<0> {
+      using type = range<>;
+    };
+
+    //Apply the `J`th of `fs` to `a`
+    template <class R, bool Handled = true>
+    struct handler_call {
+      template <std::size_t J, class A, class... Fs>
+      static constexpr R apply (A&& a, Fs&&... fs) {
+        return nth_handler<typename handler_position<J>::type>::get (
+          std::forward<Fs>(fs)...)(std::forward<A>(a));
+      }
+    };
+
+    template <>
+    struct handler_call<void, true> {
+      template <std::size_t J, class A, class... Fs>
+      static void apply (A&& a, Fs&&... fs) {
+        nth_handler<typename handler_position<J>::type>::get (
+          std::forward<Fs>(fs)...)(std::forward<A>(a));
+      }
+    };
+
+    //No handler : this is not reached (the `match` is rejected at
+    //compile time), it stands in for the call so that the only error
+    //reported is that of the `static_assert`
+    template <class R>
+    struct handler_call<R, false> {
+      template <std::size_t J, class... Args>
+      static R apply (Args&&...) {
+        std::abort ();
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
   //! \brief Primary template
   //!
   //! \anchor recursive_union_visitor_find_applicable_closure1
@@ -154,47 +470,46 @@ namespace pgs {
   //! \tparam T head of the parameter pack
   //! \tparam Ts tail of the paramter pack
   //!
-  //! If the `f` (of type `F`) under consideration can be applied to
-  //! `t` (that is, applied to a `T`) do so, else continue searching
-  //! by stripping `f` off the head of the parameter pack and
-  //! recurively invoking `visit`.
+  //! Apply to `t` (a `T`) the first of `fs` that accepts it. Which
+  //! one that is is resolved at compile time (see `handler_index<>`) :
+  //! the handler is called directly. A `T` that no handler accepts is
+  //! a compile time error.
   template <class R, class T, class... Ts>
   struct recursive_union_visitor {
 
     using result_type = R; //!< The return type of `visit`
 
-    //! \brief `f` is callable on `t` (of type `T const&`)
-    template <
-      class O, class F, class... Fs,
-      class = pgs::enable_if_t<is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O>, T const& t, F&& f, Fs&&...) {
-      return std::forward<F>(f)(t);
-    }
-    //! \brief `f` is not callable on `t` (of type `T const&`),
-    //! recurse
-    template <
-      class F, class O, class... Fs,
-      class = pgs::enable_if_t<!is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O> o, T const& t, F&&, Fs&&... fs) {
-      return recursive_union_visitor::visit (o, t, std::forward<Fs>(fs)...);
-    }
-    //! \brief `f` is callable on `t` (of type `T&`)
-    template <
-      class O, class F, class... Fs,
-      class = pgs::enable_if_t<is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O>, T& t, F&& f, Fs&&...) {
-      return std::forward<F>(f)(t);
-    }
-    //! \brief `f` is not callable on `t` (of type `T&`)
-    template <
-      class F, class O, class... Fs,
-      class = pgs::enable_if_t<!is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O> o, T& t, F&&, Fs&&...fs) {
-      return recursive_union_visitor::visit (o, t, std::forward<Fs>(fs)...);
+    //! \brief Apply the handler of `t` (of type `T const&`)
+    template <class O, class... Fs>
+    static constexpr result_type visit (
+      overload_tag<O>, T const& t, Fs&&... fs) {
+      static_assert (handler_index<T const&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      return detail::handler_call<result_type
+        , handler_index<T const&, Fs...>::value != no_handler>::template
+          apply<handler_index<T const&, Fs...>::value> (
+            t, std::forward<Fs>(fs)...);
+    }
+    //! \brief Apply the handler of `t` (of type `T&`)
+    template <class O, class... Fs>
+    static constexpr result_type visit (
+      overload_tag<O>, T& t, Fs&&... fs) {
+      static_assert (handler_index<T&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      return detail::handler_call<result_type
+        , handler_index<T&, Fs...>::value != no_handler>::template
+          apply<handler_index<T&, Fs...>::value> (
+            t, std::forward<Fs>(fs)...);
+    }
+    //! \brief Apply the handler of `t` (of type `T&&`)
+    template <class O, class... Fs>
+    static result_type visit (overload_tag<O>, T&& t, Fs&&... fs) {
+      static_assert (handler_index<T&&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      return detail::handler_call<result_type
+        , handler_index<T&&, Fs...>::value != no_handler>::template
+          apply<handler_index<T&&, Fs...>::value> (
+            std::move (t), std::forward<Fs>(fs)...);
     }
   };
 
@@ -202,47 +517,43 @@ namespace pgs {
   //!
   //! \anchor recursive_union_visitor_find_applicable_closure2
   //!
-  //! If the `f` (of type `F`) under consideration can be applied to
-  //! `t` (that is, applied to a `T`) do so, else continue searching
-  //! by stripping `f` off the head of the parameter pack and
-  //! recurively invoking `visit`.
+  //! Apply to `t` (a `T`) the first of `fs` that accepts it (see
+  //! \ref recursive_union_visitor_find_applicable_closure1 "recursive
+  //! union visitor for finding a matching closure").
   template <class T, class... Ts>
   struct recursive_union_visitor<void, T, Ts...> {
 
     using result_type = void;//!< return type of `visit`
 
-    //! \brief `f` is callable on `t` (of type `T const&`)
-    template <
-      class O, class F, class... Fs,
-      class = pgs::enable_if_t<is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O>, T const& t, F&& f, Fs&&...) {
-      std::forward<F>(f)(t);
-    }
-    //! \brief `f` is not callable on `t` (of type `T const&`),
-    //! recurse
-    template <
-      class F, class O, class... Fs,
-      class = pgs::enable_if_t<!is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O> o, T const& t, F&&, Fs&&... fs) {
-      recursive_union_visitor::visit (o, t, std::forward<Fs>(fs)...);
-    }
-    //! \brief `f` is callable on `t` (of type `T&`)
-    template <
-      class O, class F, class... Fs,
-      class = pgs::enable_if_t<is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O>, T& t, F&& f, Fs&&...) {
-      std::forward<F>(f)(t);
-    }
-    //! \brief `f` is not callable on `t` (of type `T&`)
-    template <
-      class F, class O, class... Fs,
-      class = pgs::enable_if_t<!is_callable<F, T>::value, void>
-      >
-    static result_type visit (overload_tag<O> o, T& t, F&&, Fs&&...fs) {
-      recursive_union_visitor::visit (o, t, std::forward<Fs>(fs)...);
+    //! \brief Apply the handler of `t` (of type `T const&`)
+    template <class O, class... Fs>
+    static result_type visit (overload_tag<O>, T const& t, Fs&&... fs) {
+      static_assert (handler_index<T const&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      detail::handler_call<result_type
+        , handler_index<T const&, Fs...>::value != no_handler>::template
+          apply<handler_index<T const&, Fs...>::value> (
+            t, std::forward<Fs>(fs)...);
+    }
+    //! \brief Apply the handler of `t` (of type `T&`)
+    template <class O, class... Fs>
+    static result_type visit (overload_tag<O>, T& t, Fs&&... fs) {
+      static_assert (handler_index<T&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      detail::handler_call<result_type
+        , handler_index<T&, Fs...>::value != no_handler>::template
+          apply<handler_index<T&, Fs...>::value> (
+            t, std::forward<Fs>(fs)...);
+    }
+    //! \brief Apply the handler of `t` (of type `T&&`)
+    template <class O, class... Fs>
+    static result_type visit (overload_tag<O>, T&& t, Fs&&... fs) {
+      static_assert (handler_index<T&&, Fs...>::value != no_handler
+        , "pgs::match : no handler accepts a case of the sum");
+      detail::handler_call<result_type
+        , handler_index<T&&, Fs...>::value != no_handler>::template
+          apply<handler_index<T&&, Fs...>::value> (
+            std::move (t), std::forward<Fs>(fs)...);
     }
   };
 
@@ -265,328 +576,170 @@ namespace pgs {
     {}
   };
 
-  //! \class range
+  //! \brief The type of a handler of invalid accesses into a sum (the
+  //! access of a case that is not the active one)
   //!
-  //! \brief Compile time sequence of integers
-  template <std::size_t...> struct range {};
+  //! A handler is passed the index accessed and the active index. It
+  //! must not return : it throws or ends the program.
+  using invalid_access_handler = void (*)(
+    std::size_t index, std::size_t active);
 
   //! \cond
   namespace detail {
-    template <std::size_t Z, std::size_t N, std::size_t... Ns>
-    struct mk_range  : mk_range <Z, N - 1, N, Ns...>
-    {};
 
-    template <std::size_t Z, std::size_t... Ns>
-    struct mk_range<Z, Z, Ns...> {
-      using type = range<Z, Ns...>;
-    };
-  }//namespace detail
-  //! \endcond
+    //The default handler : throw `invalid_sum_type_access` or, without
+    //exceptions, print the diagnostic and abort
+    [[noreturn]] inline void default_invalid_access (
+      std::size_t index, std::size_t active) {
+      std::string message;
+      message += "Indexing with ";
+      message += std::to_string (index);
+      message += ", but the active index is ";
+      message += std::to_string (active);
 
-  //! \brief Alias type for a range
-  template <std::size_t Z, std::size_t N>
-  using range_t =  typename detail::mk_range<Z, N>::type;
+#  if defined (PGS_NO_EXCEPTIONS)
+      std::fprintf (stderr, "pgs: %s\n", message.c_str ());
+      std::abort ();
+#  else
+      throw invalid_sum_type_access{message};
+#  endif//defined (PGS_NO_EXCEPTIONS)
+    }
 
-  //! \brief Partial specialization
-  //!
-  //! \tparam R return type
-  //! \tparam Ts Paramter pack
-  //!
-  //! Base case for return type is `R`
-  template <class R, class... Ts>
-  struct recursive_union_visitor<R, range<>, Ts...> {
-  
-    using result_type = R;//!< The return type of `visit`
-  
-    //! \brief This definition applies when `Ts...` is empty
-    //! \brief Calls to this function always throw.
-    //!
-    //! \throws invalid_sum_type_access
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<Ts...> const&, std::size_t, Fs&&...) {
-      throw invalid_sum_type_access{""};
+    inline std::atomic<invalid_access_handler>& invalid_access_slot ()
+      noexcept {
+      static std::atomic<invalid_access_handler> handler {
+        &default_invalid_access};
+      return handler;
     }
 
-    //! \brief This definition applies when `Ts...` is empty
-    //! \brief Calls to this function always throw.
-    //!
-    //! \throws invalid_sum_type_access
-    template <class... Fs>
-    static result_type visit (recursive_union<Ts...>&, std::size_t, Fs&&...) {
-      throw invalid_sum_type_access{""};
+    //Report an invalid access to the handler. This is out of line and
+    //cold : the code at the site of an access stays small
+    [[noreturn]] PGS_COLD inline void invalid_access (
+      std::size_t index, std::size_t active) {
+      invalid_access_slot ().load (std::memory_order_acquire) (index, active);
+      std::abort (); //The handler returned
     }
-  };
-  
-  //! \brief Partial specialization
-  //!
-  //!
-  //!
-  //! \tparam R return type
-  //! \tparam Ts Paramter pack
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief Install `h` as the handler of invalid accesses into sums
+  //! (`nullptr` restores the default, which throws
+  //! `invalid_sum_type_access` or, if `PGS_NO_EXCEPTIONS`, prints a
+  //! diagnostic and aborts)
   //!
-  //! Base case for return type is `void`
-  template <class... Ts>
-  struct recursive_union_visitor<void, range<>, Ts...> {
-  
-    using result_type = void;//!< The return type of `visit`
-  
-    //! \brief This definition applies when `Ts...` is empty
-    //! \brief Calls to this function always throw.
-    //!
-    //! \throws invalid_sum_type_access
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<Ts...> const&, std::size_t, Fs&&...) {
-      throw invalid_sum_type_access{""};
-    }
-  
-    //! \brief This definition applies when `Ts...` is empty
-    //! \brief Calls to this function always throw.
-    //!
-    //! \throws invalid_sum_type_access
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<Ts...>&, std::size_t, Fs&&...) {
-      throw invalid_sum_type_access{""};
-    }
-  };
-  
-  //! \brief Partial specialization
+  //! \returns The previous handler
+  inline invalid_access_handler set_invalid_access_handler (
+    invalid_access_handler h) noexcept {
+    return detail::invalid_access_slot ().exchange (
+      h != nullptr ? h : &detail::default_invalid_access
+    , std::memory_order_acq_rel);
+  }
+
+  //! \brief The handler of invalid accesses into sums
+  inline invalid_access_handler get_invalid_access_handler () noexcept {
+    return detail::invalid_access_slot ().load (std::memory_order_acquire);
+  }
+
+  //! \brief Apply the applicable closure to the `I`th value of a
+  //! `recursive_union<>`
   //!
-  //! \anchor recursive_union_visitor_find_active_type1
+  //! Each instantiation of `visit` is an entry in the table built by
+  //! \ref recursive_union_dispatcher "recursive_union_dispatcher<>".
+  //! The value is dereferenced (through a `recursive_wrapper<>` if
+  //! needs be) and the closure that is applied to it (resolved at
+  //! compile time) is that of \ref recursive_union_visitor_find_applicable_closure1
+  //! "recursive union visitor for finding a matching closure".
   //!
-  //! The role of this visitor is to "walk" the recursive union until
-  //! the active type is reached. When it is, the form of visit that
-  //! searches for the right closure to apply to the value there is
-  //! invoked (see \ref recursive_union_visitor_find_applicable_closure1 "recurs  //!
   //! \tparam R return type
-  //! \tparam I Head of an integer pack
-  //! \tparam I Tail of an integer pack
-  //! \tparam T Head of the parameter pack (of union types)
-  //! \tparam Ts Tail of the parameter pack (of union types)
-  //!
-  //! return type is `R`, `range<>` is non-empty. This specialization
-  //! applies when the head of the parameter pack is not a
-  //! `reference_wrapper<>`
-  template <class R, std::size_t I, std::size_t... Is, class T, class... Ts>
-  struct recursive_union_visitor<R, range<I, Is...>, T, Ts...> {
-  
-    using type = T; //!< The type of the value
+  //! \tparam I The index of the value to visit
+  //! \tparam Ts Parameter pack (of union types)
+  template <class R, std::size_t I, class... Ts>
+  struct recursive_union_alternative {
+
     using result_type = R; //!< The return type of `visit`
-  
-    //! \brief `const` overload (`recursive_union<type, Ts...> const&`)
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<type, Ts...> const& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is not a reference (no call 'get ()')
-        overload_tag<type> o{};
-        return recursive_union_visitor<result_type, T>::visit(
-                                        o, u.v, std::forward<Fs>(fs)...);
-      }
-      else {
-        return recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                         u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  
-    //! \brief non-`const` overload (`recursive_union<type, Ts...>&`)
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<T, Ts...>& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is not a reference (no call 'get ()')
-        overload_tag<T> o{};
-        return recursive_union_visitor<result_type, T>::visit(
-                                          o, u.v, std::forward<Fs>(fs)...);
-      }
-      else {
-        return recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                           u.r, i, std::forward<Fs>(fs)...);
-      }
+
+    //! \brief Visit the `I`th value of `u` (`U` is
+    //! `recursive_union<Ts...>` or another storage type providing
+    //! `union_ref`, possibly `const` qualified). The value is passed
+    //! as an rvalue if `u` is one.
+    template <class U, class... Fs>
+    static constexpr result_type visit (U&& u, Fs&&... fs) {
+      using type = decay_t<decltype (union_ref<I> (u))>;
+      return recursive_union_visitor<result_type, type>::visit (
+                                    overload_tag<type>{}
+                                  , detail::forward_case<U, I> (union_ref<I> (u))
+                                  , std::forward<Fs>(fs)...);
     }
   };
-  
+
+  //! \brief Primary template
+  template <class R, class I, class... Ts>
+  struct recursive_union_dispatcher;
+
   //! \brief Partial specialization
   //!
-  //! \anchor recursive_union_visitor_find_active_type2
+  //! \anchor recursive_union_dispatcher
   //!
-  //! The role of this visitor is to "walk" the recursive union until
-  //! the active type is reached. When it is, the form of visit that
-  //! searches for the right closure to apply to the value there is
-  //! invoked (see \ref recursive_union_visitor_find_applicable_closure1 "recursive union visitor for finding a matching closure")
+  //! Dispatch on the active index of a `recursive_union<>` in
+  //! constant time. A table of function pointers, one per case of the
+  //! union, is built at compile time and the active index is used to
+  //! subscript it : a single indirect call whatever the number of
+  //! cases.
   //!
   //! \tparam R return type
-  //! \tparam I Head of an integer pack
-  //! \tparam I Tail of an integer pack
-  //! \tparam T Head of the parameter pack
-  //! \tparam Ts Tail of the parameter pack (of union types)
-  //! 
-  //! return type is `R`, `range<>` is non-empty. This specialization
-  //! applies when the head of the parameter pack is a
-  //! `recursive_wrapper<>`
-  template <class R, std::size_t I, std::size_t... Is, class T, class... Ts>
-  struct recursive_union_visitor<R, range<I, Is...>, recursive_wrapper<T>, Ts...> {
-  
-    using type = T; //!< The type held by the value
-    using U = recursive_wrapper<type>;//!< The type of the value
-    using result_type = R; //!< The type returned by `visit`
-    
-    //! \brief `const` overload (`recursive_union<U, Ts...> const&`)
-    template <class... Fs>
-    static result_type visit (
-       recursive_union<U, Ts...> const& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is of type recursive_wrapper<type>, call 'get ()'
-        overload_tag<type> o{};
-        return recursive_union_visitor<result_type, type>::visit(
-                                     o, u.v.get (), std::forward<Fs>(fs)...);
-      }
-      else {
-        return recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                            u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  
-    //! \brief non-`const` overload (`recursive_union<U, Ts...>&`)
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<U, Ts...>& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is of type recursive_wrapper<type>, call 'get ()'
-        overload_tag<type> o{};
-        return recursive_union_visitor<result_type, T>::visit(
-                                      o, u.v.get (), std::forward<Fs>(fs)...);
-      }
-      else {
-        return recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                             u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  };
-  
-  //! \brief Partial specialization
-  //!
-  //! \anchor recursive_union_visitor_find_active_type3
-  //!
-  //! The role of this visitor is to "walk" the recursive union until
-  //! the active type is reached. When it is, the form of visit that
-  //! searches for the right closure to apply to the value there is
-  //! invoked (see \ref recursive_union_visitor_find_applicable_closure2 "recursive union visitor for finding a matching closure")
-  //!
-  //! \tparam I Head of an integer pack
-  //! \tparam I Tail of an integer pack
-  //! \tparam T Head of the parameter pack
-  //! \tparam Ts Tail of the parameter pack (of union types)
-  //!
-  //! return type is `void`, `range<>` is non-empty.! This specialization
-  //! applies when the head of the parameter pack is not a
-  //! `recursive_wrapper<>`
-  template <std::size_t I, std::size_t... Is, class T, class... Ts>
-  struct recursive_union_visitor<void, range<I, Is...>, T, Ts...> {
-  
-    using type = T; //!< The type of the value
-    using result_type = void; //!< The return type of `visit`
-  
-    //! \brief 'const' overload ('recursive_union<type, Ts...> const& u')
-    template <class... Fs>
-    static result_type
-    visit (
-      recursive_union<type, Ts...> const& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is not a wrapper (no call 'get ()')
-        overload_tag<type> o{};
-        recursive_union_visitor<result_type, type>::visit(
-                                              o, u.v, std::forward<Fs>(fs)...);
-      }
-      else {
-        recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                              u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  
-    //! \brief 'non-const' overload ('recursive_union<T, Ts...>& u')
-    template <class... Fs>
-    static result_type
-    visit (
-      recursive_union<T, Ts...>& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is not a wrapper (no call 'get ()')
-        overload_tag<type> o{};
-        recursive_union_visitor<result_type, type>::visit(
-                                              o, u.v, std::forward<Fs>(fs)...);
-      }
-      else {
-        recursive_union_visitor<result_type, range<Is...>, Ts...>::visit(
-                                              u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  
-  };
-  
-  //! \brief Partial specialization
-  //!
-  //! \anchor recursive_union_visitor_find_active_type4
-  //!
-  //! The role of this visitor is to "walk" the recursive union until
-  //! the active type is reached. When it is, the form of visit that
-  //! searches for the right closure to apply to the value there is
-  //! invoked (see \ref recursive_union_visitor_find_applicable_closure2 "recursive union visitor for finding a matching closure")
-  //!
-  //! \tparam I Head of an integer pack
-  //! \tparam I Tail of an integer pack
-  //! \tparam T Head of the parameter pack
-  //! \tparam Ts Tail of the parameter pack (of union types)
-  //!
-  //! return type is `void`, `range<>` is non-empty. This specialization
-  //! applies when the head of the parameter pack is a
-  //! `recursive_wrapper<>`
-  template <std::size_t I, std::size_t... Is, class T, class... Ts>
-  struct recursive_union_visitor<
-     void, range<I, Is...>, recursive_wrapper<T>, Ts...> {
-
-    //U='recursive_wrapper<T>', 'Ts', return type 'void'
-  
-    using type = T; //!< The type held by the value
-    using U = recursive_wrapper<type>;//!< The type of the value
-    using result_type = void;//!< The type returned by `visit`
-  
-    //! \brief `const` overload (`recursive_union<U, Ts...> const&`)
-    template <class... Fs>
-    static result_type visit (
-       recursive_union<U, Ts...> const& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is a reference (call 'get ()')
-        overload_tag<type> o{};
-        recursive_union_visitor<void, type>::visit(
-                                       o, u.v.get (), std::forward<Fs>(fs)...);
-      }
-      else {
-        recursive_union_visitor<void, range<Is...>, Ts...>::visit (
-                                              u.r, i, std::forward<Fs>(fs)...);
-      }
-    }
-  
-    //! \brief non-`const` overload (`recursive_union<U, Ts...>&`)
-    template <class... Fs>
-    static result_type visit (
-      recursive_union<U, Ts...>& u, std::size_t i, Fs&&... fs) {
-      if (i == I) {
-        //'u' is a reference (call 'get ()')
-        overload_tag<type> o{};
-        recursive_union_visitor<void, type>::visit(
-                                       o, u.v.get (), std::forward<Fs>(fs)...);
-      }
-      else {
-        recursive_union_visitor<void, range<Is...>, Ts...>::visit(
-                                              u.r, i, std::forward<Fs>(fs)...);
-      }
+  //! \tparam Is Integer pack (the indices `0` to `sizeof...(Ts) - 1`)
+  //! \tparam Ts Parameter pack (of union types)
+  template <class R, std::size_t... Is, class... Ts>
+  struct recursive_union_dispatcher<R, range<Is...>, Ts...> {
+
+    using result_type = R; //!< The return type of `visit`
+
+    //! \brief Visit the value at index `i` of `u` (`U` is
+    //! `recursive_union<Ts...>` or another storage type providing
+    //! `union_ref`, possibly `const` qualified)
+    //!
+    //! \pre `i < sizeof...(Ts)`
+    //!
+    //! Every handler must be the handler of some case (see
+    //! `match_table<>`) : one that is not is a compile time error. If
+    //! `u` is an rvalue, the value is passed to its handler as one.
+    template <class U, class... Fs>
+    static constexpr result_type visit (U&& u, std::size_t i, Fs&&... fs) {
+      static_assert (match_table<
+          std::tuple<decltype (detail::forward_case<U, Is> (
+            union_ref<Is> (std::declval<U&> ())))...>
+        , Fs...>::irredundant
+        , "pgs::match : a handler is never applied (an earlier handler "
+          "accepts every case it does, or it accepts no case)");
+      return table<U, Fs...>::entries[i] (
+        std::forward<U>(u), std::forward<Fs>(fs)...);
     }
+
+  private:
+    //The table (a member rather than a local so that `visit` may be
+    //evaluated in a constant expression)
+    template <class U, class... Fs>
+    struct table {
+      using entry_type = result_type (*)(U&&, Fs&&...);
+      static constexpr entry_type entries[] = {
+        &recursive_union_alternative<
+            result_type, Is, Ts...>::template visit<U, Fs...>...
+      };
+    };
   };
-  
+
+  //! \cond
+  template <class R, std::size_t... Is, class... Ts>
+    template <class U, class... Fs>
+  constexpr typename recursive_union_dispatcher<
+      R, range<Is...>, Ts...>::template table<U, Fs...>::entry_type
+    recursive_union_dispatcher<
+      R, range<Is...>, Ts...>::table<U, Fs...>::entries[];
+  //! \endcond
+
   //! \brief Full specialization
-  //! 
+  //!
   //! This specialization applies when there are no more "cases" in
   //! the sum
   template <>
@@ -594,25 +747,112 @@ namespace pgs {
     //! \brief `copy` is a no-op
     void copy (std::size_t, recursive_union const&) {}
     //! \brief `move` is a no-op
-    void move (std::size_t, recursive_union&&) {}
+    void move (std::size_t, recursive_union&&) noexcept {}
+    //! \brief `assign` is a no-op
+    void assign (std::size_t, recursive_union const&) {}
+    //! \brief `move_assign` is a no-op
+    void move_assign (std::size_t, recursive_union&&) noexcept {}
     //! \brief `destruct` is a no-op
-    void destruct (std::size_t) {}
+    void destruct (std::size_t) noexcept {}
     //! \brief `compare` returns `false`
     bool compare (std::size_t, recursive_union const&) const { return false; }
+    //! \brief `hash` returns 0
+    std::size_t hash (std::size_t) const { return 0; }
   };
   
   #  if defined(_MSC_VER)
   #    pragma warning(push)
   #    pragma warning(disable:4624)
   #  endif//defined (_MSC_VER)
-  
+
+  //! \cond
+  namespace detail {
+
+    struct union_head_t {};
+    struct union_tail_t {};
+
+    //The members of a `recursive_union<T, Ts...>` : an anonymous
+    //union of a field `v` of type `T` and a field `r` of type
+    //`recursive_union<Ts...>`. Unless the destruction of every case
+    //is trivial (and so then that of the union), the destructor does
+    //nothing (the active field is destroyed by `destruct`)
+    template <bool Trivial, class T, class... Ts>
+    struct recursive_union_members {
+      recursive_union_members ()
+      {}
+
+      template <class... Args>
+      constexpr explicit recursive_union_members (
+        union_head_t, Args&&... args)
+        : v (std::forward<Args>(args)...)
+      {}
+
+      template <class... Args>
+      constexpr explicit recursive_union_members (
+        union_tail_t, Args&&... args)
+        : r (std::forward<Args>(args)...)
+      {}
+
+      ~recursive_union_members ()
+      {}
+
+      union {
+        T v;
+        recursive_union<Ts...> r;
+      };
+    };
+
+    template <class T, class... Ts>
+    struct recursive_union_members<true, T, Ts...> {
+      recursive_union_members ()
+      {}
+
+      template <class... Args>
+      constexpr explicit recursive_union_members (
+        union_head_t, Args&&... args)
+        : v (std::forward<Args>(args)...)
+      {}
+
+      template <class... Args>
+      constexpr explicit recursive_union_members (
+        union_tail_t, Args&&... args)
+        : r (std::forward<Args>(args)...)
+      {}
+
+      union {
+        T v;
+        recursive_union<Ts...> r;
+      };
+    };
+
+    template <class T, class... Ts>
+    using recursive_union_base = recursive_union_members<
+      and_<
+          is_trivially_destructible_case<T>
+        , is_trivially_destructible_case<Ts>...>::value
+      , T, Ts...>;
+
+  }//namespace detail
+  //! \endcond
+
   //! \brief Partial specialization
   //!
+  //! The union of a field `v` of type `T` and a field `r` of type
+  //! `recursive_union<Ts...>`. Its destruction is trivial if that of
+  //! every one of `T, Ts...` is, and so its copy if their copy is
+  //! (`recursive_union<>` of such cases is trivially copyable).
+  //!
   //! \tparam T Type of `v` in the union
   //! \tparam Ts `recursive_union<Ts...>` is the type of `r` in the union
   template <class T, class... Ts>
-  struct recursive_union<T, Ts...> {
-  
+  struct recursive_union<T, Ts...> : detail::recursive_union_base<T, Ts...> {
+  private:
+    using base_type = detail::recursive_union_base<T, Ts...>;
+
+  public:
+    using base_type::v; //!< Value or...
+    using base_type::r; //!< ... recursive union
+
     //! \brief Default ctor
     recursive_union () 
     {}
@@ -621,8 +861,8 @@ namespace pgs {
     //!
     //! `T` and `U` are the same
     template <class... Args>
-    explicit recursive_union (constructor<T>, Args&&... args) 
-      : v (std::forward<Args>(args)...)
+    constexpr explicit recursive_union (constructor<T>, Args&&... args)
+      : base_type (detail::union_head_t{}, std::forward<Args>(args)...)
     {}
 
     //! \brief Construct (a `recursive_wrapper<T>`) into `v`
@@ -633,9 +873,9 @@ namespace pgs {
     pgs::enable_if_t<
       is_recursive_wrapper_containing<T, U>::value, int> = 0
     >
-    explicit recursive_union (constructor<U>, Args&&... args)
+    constexpr explicit recursive_union (constructor<U>, Args&&... args)
       noexcept (std::is_nothrow_constructible<U, Args...>::value)
-    : v (std::forward<Args>(args)...)
+    : base_type (detail::union_head_t{}, std::forward<Args>(args)...)
     {}
 
     //! \brief Construct into `r`
@@ -648,15 +888,11 @@ namespace pgs {
           not_is_same<T, U>
         , not_is_recursive_wrapper_containing<T, U>>::value, int> = 0
     >
-    explicit recursive_union (constructor<U> t, Args&&... args)
+    constexpr explicit recursive_union (constructor<U> t, Args&&... args)
       noexcept(
          std::is_nothrow_constructible<Ts..., constructor<U>, Args...>::value
       )
-      : r (t, std::forward<Args>(args)...)
-    {}
-  
-    //! \brief Dtor
-    ~recursive_union () 
+      : base_type (detail::union_tail_t{}, t, std::forward<Args>(args)...)
     {}
   
     //! \brief Copy
@@ -703,6 +939,45 @@ namespace pgs {
         r.move (i - 1, std::move (u.r));
       }
     }
+
+    //! \brief Copy-assign
+    //!
+    //! If `i` is \f$0\f$ then copy-assign `u.v` to `v` (which is
+    //! active) else, recursively invoke `assign` on `r` and a
+    //! decremented `i`.
+    //!
+    //! \param i When zero, the destination of the assignment
+    //! \param u Source of the assignment
+    void assign (std::size_t i, recursive_union const& u) {
+      if (i == 0) {
+        detail::case_assign (v, u.v);
+      }
+      else {
+        r.assign (i - 1, u.r);
+      }
+    }
+
+    //! \brief Move-assign
+    //!
+    //! If `i` is \f$0\f$ then move-assign `u.v` to `v` (which is
+    //! active) else, recursively invoke `move_assign` on `r` and a
+    //! decremented `i`.
+    //!
+    //! \param i When zero, the destination of the assignment
+    //! \param u Source of the assignment
+    void move_assign (std::size_t i, recursive_union&& u)
+      noexcept (
+        detail::is_nothrow_case_move_assignable<T>::value
+       && noexcept (std::declval<recursive_union>().r.move_assign (
+                                                  i - 1, std::move (u.r)))
+       ) {
+      if (i == 0) {
+        detail::case_move_assign (v, std::move (u.v));
+      }
+      else {
+        r.move_assign (i - 1, std::move (u.r));
+      }
+    }
   
     //! \brief Destruct
     //!
@@ -733,15 +1008,16 @@ namespace pgs {
       noexcept {
         return i == 0 ? v == rhs.v : r.compare (i - 1, rhs.r);
     }
-  
-    //! \brief An anonymous union
+
+    //! \brief Hash
     //!
-    //! An anonymous union consisting of a field `v` of type `T` and a
-    //! field `r` of type `recursive_union<Ts...>`
-    union {
-      T v; //!< Value or...
-      recursive_union<Ts...> r; //!< ... recursive union
-    };
+    //! If `i` is \f$0\f$ then hash `v` else, recursively invoke
+    //! `hash` on `r` and a decremented `i`.
+    //!
+    //! \param i When zero, indicates the value to hash
+    std::size_t hash (std::size_t i) const {
+      return i == 0 ? detail::case_hash (v) : r.hash (i - 1);
+    }
   };
   
 #  if defined(_MSC_VER)
@@ -9,17 +9,54 @@
 //! software license)
 //! \copyright Copyright Shayne Fletcher, 2015-2016
 
+#include <pgs/config.hpp>
+#include <pgs/logical.hpp>
 #include <pgs/type_traits.hpp>
+#include <pgs/worklist.hpp>
 
+#include <functional> // std::hash<>
+#include <memory> // std::allocator<>, std::allocator_traits<>
 #include <utility> // std::forward<>()
 
 namespace pgs {
 
 //! \cond
-template <class T>
+template <class T, class A = std::allocator<T>>
 class recursive_wrapper; //fwd. decl.
 //! \endcond
 
+//! \brief A type to select the constructor of `recursive_wrapper<>`
+//! that takes ownership of an existing instance
+struct adopt_t {};
+
+//! \cond
+namespace detail {
+
+  //`true` if the first of `Args...` is `std::allocator_arg_t`
+  template <class... Args>
+  struct is_allocator_arg_first : std::false_type
+  {};
+
+  template <class A0, class... Args>
+  struct is_allocator_arg_first<A0, Args...>
+    : std::is_same<decay_t<A0>, std::allocator_arg_t>
+  {};
+
+  //`true` if any instance of the allocator `A` frees what another
+  //allocated and one can be made at will : a wrapper's allocator need
+  //then not be kept for its node to be freed (a default constructed
+  //one will do). Being empty is not enough, `A` must say so (see
+  //`std::allocator_traits<>::is_always_equal`)
+  template <class A>
+  struct is_stateless_allocator
+    : and_<
+          typename std::allocator_traits<A>::is_always_equal
+        , std::is_default_constructible<A>>
+  {};
+
+}//namespace detail
+//! \endcond
+
 //! \brief Primary template of a metafunction to classify a type as
 //! `recursive_wrapper<>` or not
 //!
@@ -31,8 +68,8 @@ struct is_recursive_wrapper : std::false_type
 
 //! \brief Partial specialization for types that are recursive
 //! wrappers
-template <class T> 
-struct is_recursive_wrapper<recursive_wrapper<T>> : std::true_type 
+template <class T, class A> 
+struct is_recursive_wrapper<recursive_wrapper<T, A>> : std::true_type 
 {};
 
 //! \brief Negation of the `is_recursive_wrapper<>` metafunction
@@ -50,8 +87,8 @@ struct recursive_wrapper_unwrap {
 
 //! \brief Partial specialization for types that are recursive
 //! wrappers
-template <class T>
-struct recursive_wrapper_unwrap<recursive_wrapper<T>> {
+template <class T, class A>
+struct recursive_wrapper_unwrap<recursive_wrapper<T, A>> {
   typedef T type; //!< The type of the value contained by a recursive
                   //!wrapper
 };
@@ -77,31 +114,135 @@ template <class T, class U>
 using not_is_recursive_wrapper_containing =
   negation<is_recursive_wrapper_containing<T, U>>;
 
-//! types
+//! \brief A metafunction to determine if the storage obtained from
+//! an allocator `A` is aligned as that of `operator new` is (to at
+//! least `alignof (std::max_align_t)`)
+//!
+//! The default is that it is not known to be. It is for
+//! `std::allocator<>` (and `pool_allocator<>`). Specialize this
+//! template (to derive from `std::true_type`) for allocators that
+//! obtain their storage from `operator new` (or `std::malloc`) : only
+//! then may a sum keep the address of a value they allocated in a
+//! tagged pointer (see `is_tagged_pointer_representable<>`).
+//!
+//! \tparam A The allocator type
+template <class A>
+struct is_max_aligned_allocator : std::false_type
+{};
+
+//! \brief Partial specialization for the default allocator
 template <class T>
+struct is_max_aligned_allocator<std::allocator<T>> : std::true_type
+{};
+
+//! types
+//!
+//! The `type` instance is obtained from an allocator (of type `A`
+//! rebound to `type`). To have a value allocated by a particular
+//! allocator, construct the wrapper with `std::allocator_arg` and the
+//! allocator ahead of the arguments of `type`'s constructor. These
+//! pass through `sum_type<>`'s constructor unchanged :
+//! \code{.cpp}
+//!   list<int>{constructor<cons_t<int>>{}, std::allocator_arg, a, 1, tl}
+//! \endcode
+//! A copy uses the allocator of the wrapper it copies (see
+//! `std::allocator_traits<>::select_on_container_copy_construction`).
+//!
+//! A `recursive_wrapper<>` that has been moved from no longer owns a
+//! `type` instance (the instance changes hands, it is not copied or
+//! moved). It may only be destroyed or assigned to.
+//!
+//! The destruction of nested wrappers is iterative (see
+//! `iterative_destruction<>`) when the allocator is stateless (any
+//! instance frees what another allocated, see
+//! `std::allocator_traits<>::is_always_equal`, and one can be default
+//! constructed) or is trivially copyable and no bigger than two
+//! pointers (as is `arena_allocator<>`). When it is stateless, so is,
+//! on request, their copy construction (see `iterative_copy<>`).
+//! Their comparison may be made iterative too (see
+//! `iterative_equality<>`).
+//!
+//! \tparam T The type of the wrapped value
+//! \tparam A The allocator type
+template <class T, class A>
 class recursive_wrapper {
+public:
+  typedef T type;   //!< Alias `type` for `T`
+  //! The allocator type (`A` rebound to `type`)
+  typedef typename std::allocator_traits<A>::template rebind_alloc<T>
+    allocator_type;
+
 private:
-  T* p_;
+  typedef std::allocator_traits<allocator_type> alloc_traits;
+  //Whether the allocator need not be kept to free a node
+  typedef detail::is_stateless_allocator<allocator_type> stateless;
+
+  //The allocator (a base, so taking no room when empty) and the
+  //pointer
+  struct holder : allocator_type {
+    T* p_;
+    holder (allocator_type const& a, T* p) noexcept
+      : allocator_type (a), p_ (p)
+    {}
+  } h_;
 
-private:  
+private:
   recursive_wrapper& assign (T const& rhs);
-
-public:
-  typedef T type;   //!< Alias `type` for `T`
+  recursive_wrapper& assign (T const& rhs, std::true_type);
+  recursive_wrapper& assign (T const& rhs, std::false_type);
+
+  template <class... Args>
+  static T* allocate (allocator_type& a, Args&&... args);
+  static void deallocate (allocator_type& a, T* p) noexcept;
+
+  //Whether the allocator can be kept by the destruction worklist
+  typedef detail::destruction_worklist::is_state<allocator_type> keepable;
+
+  //Destruction (deferred to the worklist if the allocator is
+  //stateless or can be kept there)
+  static void destroy (void* p, void const* a) noexcept;
+  static allocator_type kept (void const* a, std::true_type) noexcept;
+  static allocator_type kept (void const* a, std::false_type) noexcept;
+  void destroy (std::true_type) noexcept;
+  void destroy (std::false_type) noexcept;
+
+  //Copy construction (deferred to the worklist if
+  //`iterative_copy<T>` and the allocator need not be kept)
+  static T* copy (allocator_type& a, T const& rhs);
+  static T* copy (allocator_type& a, T const& rhs, std::true_type);
+  static T* copy (allocator_type& a, T const& rhs, std::false_type);
+  static void construct (void* p, void const* rhs);
+  static void destruct (void* p) noexcept;
+  static void free (void* p) noexcept;
+  bool cancel () noexcept;
+  bool cancel (std::true_type) noexcept;
+  bool cancel (std::false_type) noexcept;
 
 public:
 
-  //! Forwarding ctor (heap allocates `type` instance)
-  template <class... Args> recursive_wrapper (Args&&... args);
+  //! Forwarding ctor (allocates `type` instance)
+  template <class... Args,
+    enable_if_t<!detail::is_allocator_arg_first<Args...>::value, int> = 0>
+  recursive_wrapper (Args&&... args);
+  //! Forwarding ctor (allocates `type` instance from `a`)
+  template <class... Args>
+    recursive_wrapper (std::allocator_arg_t, A const& a, Args&&... args);
   //! Copy ctor
   recursive_wrapper (recursive_wrapper const& rhs);
+  //! Copy ctor (preferred to the forwarding ctor for non-`const`
+  //! `rhs`)
+  recursive_wrapper (recursive_wrapper& rhs);
   //! Copy-construct from `type`
   recursive_wrapper (type const& rhs);
-  //! Move-construct from `recursive_wrapper`
-  recursive_wrapper(recursive_wrapper&& rhs);
+  //! Move-construct from `recursive_wrapper` (takes ownership of the
+  //! `type` instance of `rhs`)
+  recursive_wrapper(recursive_wrapper&& rhs) noexcept;
   //! Move-construct from `type`
   recursive_wrapper(type&& rhs);
-  //! Destructor (frees heap-allocated `type` instance)
+  //! Take ownership of `p` (a `type` instance obtained from
+  //! `release ()`, allocated by `a`)
+  recursive_wrapper(adopt_t, type* p, A const& a = A ()) noexcept;
+  //! Destructor (frees the `type` instance)
   ~recursive_wrapper();
 
   //! Copy-assign from `recursive_wrapper`
@@ -113,9 +254,17 @@ public:
   //! Move-assign from `type`
   recursive_wrapper& operator=(type&& rhs);
 
-  //! Swap with `recursive_wrapper`
+  //! Swap with `recursive_wrapper` (allocators included)
   void swap(recursive_wrapper& rhs) noexcept;
 
+  //! Relinquish ownership of the `type` instance (it is the caller's
+  //! responsibility to hand it back to a `recursive_wrapper` by way
+  //! of the adopting constructor)
+  type* release() noexcept;
+
+  //! The allocator
+  allocator_type get_allocator() const noexcept;
+
   type& get(); //!< Accessor to the `type` instance
   type const& get() const; //!< Accessor to the `type` instance
   type* get_pointer(); //!< Accessor to the `type` instance
@@ -123,106 +272,318 @@ public:
 };
 
 //! \brief `true` if contained values compare equal, false otherwise
-template <class T>
+//! (a value compares equal to itself without being examined)
+template <class T, class A>
 bool operator== (
-  recursive_wrapper<T> const& lhs, recursive_wrapper<T> const& rhs) {
-  return lhs.get () == rhs.get ();
+  recursive_wrapper<T, A> const& lhs, recursive_wrapper<T, A> const& rhs) {
+  return detail::boxed_equal (lhs.get (), rhs.get ());
 }
 
 //! \brief `true` if contained values compare not equal, `false`
 //! otherwise
-template <class T>
+template <class T, class A>
 bool operator!= (
-  recursive_wrapper<T> const& lhs, recursive_wrapper<T> const& rhs) {
-  return !(lhs.get () == rhs.get ());
+  recursive_wrapper<T, A> const& lhs, recursive_wrapper<T, A> const& rhs) {
+  return !(lhs == rhs);
+}
+
+//! \brief `true` if the contained value of `lhs` is less than that of
+//! `rhs`, `false` otherwise
+template <class T, class A>
+bool operator< (
+  recursive_wrapper<T, A> const& lhs, recursive_wrapper<T, A> const& rhs) {
+  return detail::boxed_less (lhs.get (), rhs.get ());
 }
 
 }//namespace pgs
 
+namespace std {
+
+//! \brief Hash of a `recursive_wrapper<>` (the hash of its value)
+template <class T, class A>
+struct hash<pgs::recursive_wrapper<T, A>> {
+  //! \brief The hash of `w.get ()`
+  std::size_t operator () (pgs::recursive_wrapper<T, A> const& w) const {
+    return hash<T>{}(w.get ());
+  }
+};
+
+}//namespace std
+
 //! \cond
 namespace pgs {
 
-template<class T>
-  template <class... Args> 
-recursive_wrapper<T>::recursive_wrapper (Args&&... args) : 
-    p_(new T (std::forward<Args>(args)...)) {
+template <class T, class A>
+  template <class... Args>
+T* recursive_wrapper<T, A>::allocate (allocator_type& a, Args&&... args) {
+  T* p = alloc_traits::allocate (a, 1);
+  PGS_TRY {
+    alloc_traits::construct (a, p, std::forward<Args>(args)...);
+  }
+  PGS_CATCH_ALL {
+    alloc_traits::deallocate (a, p, 1);
+    PGS_RETHROW
+  }
+  return p;
 }
 
-template<class T>
-recursive_wrapper<T>::recursive_wrapper (recursive_wrapper const& rhs) : 
-    p_ (new T (rhs.get ())) {
+template <class T, class A>
+void recursive_wrapper<T, A>::deallocate (allocator_type& a, T* p) noexcept {
+  alloc_traits::destroy (a, p);
+  alloc_traits::deallocate (a, p, 1);
 }
 
-template<class T>
-recursive_wrapper<T>::recursive_wrapper (T const& rhs) : p_ (new T (rhs)) {
+template<class T, class A>
+  template <class... Args,
+    enable_if_t<!detail::is_allocator_arg_first<Args...>::value, int>>
+recursive_wrapper<T, A>::recursive_wrapper (Args&&... args) :
+    h_ (allocator_type (), nullptr) {
+  h_.p_ = allocate (h_, std::forward<Args>(args)...);
 }
 
-template<class T>
-recursive_wrapper<T>::recursive_wrapper(recursive_wrapper&& rhs) : 
-    p_ (new T (std::move (rhs.get ()))) {
+template<class T, class A>
+  template <class... Args>
+recursive_wrapper<T, A>::recursive_wrapper (
+  std::allocator_arg_t, A const& a, Args&&... args) :
+    h_ (allocator_type (a), nullptr) {
+  h_.p_ = allocate (h_, std::forward<Args>(args)...);
 }
 
-template <class T>
-recursive_wrapper<T>::recursive_wrapper(T&& rhs) : p_ (new T (std::move (rhs))) {
+template<class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper (recursive_wrapper const& rhs) :
+    h_ (alloc_traits::select_on_container_copy_construction (rhs.h_)
+      , nullptr) {
+  h_.p_ = copy (h_, rhs.get ());
 }
 
-template <class T>
-recursive_wrapper<T>::~recursive_wrapper() {
-  delete p_; 
+template<class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper (recursive_wrapper& rhs) :
+    recursive_wrapper (static_cast<recursive_wrapper const&>(rhs)) {
 }
 
-template <class T>
-recursive_wrapper<T>& 
-  recursive_wrapper<T>::operator=(recursive_wrapper const& rhs){ 
-  return assign (rhs.get()); 
+template<class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper (T const& rhs) :
+    h_ (allocator_type (), nullptr) {
+  h_.p_ = copy (h_, rhs);
 }
 
-template <class T>
-recursive_wrapper<T>& recursive_wrapper<T>::operator=(T const& rhs) { 
-  return assign (rhs); 
+template<class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper(recursive_wrapper&& rhs) noexcept :
+    h_ (static_cast<allocator_type const&>(rhs.h_), rhs.release ()) {
 }
 
-template <class T>
-recursive_wrapper<T>& recursive_wrapper<T>::assign (T const& rhs) { 
-  this->get() = rhs; return *this; 
+template <class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper(T&& rhs) :
+    h_ (allocator_type (), nullptr) {
+  h_.p_ = allocate (h_, std::move (rhs));
 }
 
-template <class T>
-void recursive_wrapper<T>::swap(recursive_wrapper& rhs) noexcept { 
-  std::swap (p_, rhs.p_); 
+template <class T, class A>
+recursive_wrapper<T, A>::recursive_wrapper(
+  adopt_t, T* p, A const& a) noexcept : h_ (allocator_type (a), p) {
 }
 
-template <class T>
-recursive_wrapper<T>&
-recursive_wrapper<T>::operator=(recursive_wrapper&& rhs) noexcept { 
-  swap (rhs); 
-  return *this; 
+template <class T, class A>
+void recursive_wrapper<T, A>::destroy (void* p, void const* a) noexcept {
+  allocator_type k = kept (a, stateless{});
+  deallocate (k, static_cast<T*>(p));
 }
 
-template <class T>
-recursive_wrapper<T>&
-recursive_wrapper<T>::operator=(T&& rhs) { 
-  get() = std::move (rhs); 
-  return *this; 
+//The allocator of a node whose destruction was deferred : made anew
+//if stateless, else the copy kept by the worklist
+template <class T, class A>
+typename recursive_wrapper<T, A>::allocator_type
+  recursive_wrapper<T, A>::kept (void const*, std::true_type) noexcept {
+  return allocator_type ();
+}
+
+template <class T, class A>
+typename recursive_wrapper<T, A>::allocator_type
+  recursive_wrapper<T, A>::kept (void const* a, std::false_type) noexcept {
+  return *static_cast<allocator_type const*>(a);
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::destroy (std::true_type) noexcept {
+  allocator_type const& a = h_;
+  detail::destruction_worklist::destroy (
+    h_.p_, &destroy, &a, stateless::value ? 0 : sizeof (allocator_type));
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::destroy (std::false_type) noexcept {
+  deallocate (h_, h_.p_);
+}
+
+template <class T, class A>
+T* recursive_wrapper<T, A>::copy (allocator_type& a, T const& rhs) {
+  return copy (a, rhs, std::integral_constant<bool,
+    iterative_copy<T>::value && stateless::value>{});
+}
+
+template <class T, class A>
+T* recursive_wrapper<T, A>::copy (
+  allocator_type& a, T const& rhs, std::true_type) {
+  T* p = alloc_traits::allocate (a, 1);
+  PGS_TRY {
+    detail::copy_worklist::instance ().copy (
+      p, &rhs, &construct, &destruct, &free);
+  }
+  PGS_CATCH_ALL {
+    alloc_traits::deallocate (a, p, 1);
+    PGS_RETHROW
+  }
+  return p;
+}
+
+template <class T, class A>
+T* recursive_wrapper<T, A>::copy (
+  allocator_type& a, T const& rhs, std::false_type) {
+  return allocate (a, rhs);
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::construct (void* p, void const* rhs) {
+  allocator_type a;
+  alloc_traits::construct (
+    a, static_cast<T*>(p), *static_cast<T const*>(rhs));
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::destruct (void* p) noexcept {
+  allocator_type a;
+  alloc_traits::destroy (a, static_cast<T*>(p));
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::free (void* p) noexcept {
+  allocator_type a;
+  alloc_traits::deallocate (a, static_cast<T*>(p), 1);
+}
+
+//A node whose copy is pending (abandoned by an exception) is freed
+//unconstructed
+template <class T, class A>
+bool recursive_wrapper<T, A>::cancel () noexcept {
+  return cancel (std::integral_constant<bool,
+    iterative_copy<T>::value && stateless::value>{});
+}
+
+template <class T, class A>
+bool recursive_wrapper<T, A>::cancel (std::true_type) noexcept {
+  detail::copy_worklist& w = detail::copy_worklist::instance ();
+  if (!w.active () || !w.cancel (h_.p_))
+    return false;
+  free (h_.p_);
+  return true;
+}
+
+template <class T, class A>
+bool recursive_wrapper<T, A>::cancel (std::false_type) noexcept {
+  return false;
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>::~recursive_wrapper() {
+  if (h_.p_ != nullptr && !cancel ())
+    destroy (std::integral_constant<bool,
+      iterative_destruction<T>::value
+      && (stateless::value || keepable::value)>{});
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>&
+  recursive_wrapper<T, A>::operator=(recursive_wrapper const& rhs){
+  return assign (rhs.get());
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>& recursive_wrapper<T, A>::operator=(T const& rhs) {
+  return assign (rhs);
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>& recursive_wrapper<T, A>::assign (T const& rhs) {
+  if (h_.p_ == nullptr) { //moved from
+    h_.p_ = copy (h_, rhs);
+    return *this;
+  }
+  return assign (rhs, std::integral_constant<bool,
+    iterative_copy<T>::value && stateless::value>{});
+}
+
+//Nested values are copied iteratively (a copy is made and swapped in)
+template <class T, class A>
+recursive_wrapper<T, A>&
+  recursive_wrapper<T, A>::assign (T const& rhs, std::true_type) {
+  recursive_wrapper fresh (rhs);
+  swap (fresh);
+  return *this;
+}
+
+//The value is assigned in place (reusing the node)
+template <class T, class A>
+recursive_wrapper<T, A>&
+  recursive_wrapper<T, A>::assign (T const& rhs, std::false_type) {
+  this->get() = rhs;
+  return *this;
+}
+
+template <class T, class A>
+void recursive_wrapper<T, A>::swap(recursive_wrapper& rhs) noexcept {
+  using std::swap;
+  swap (static_cast<allocator_type&>(h_), static_cast<allocator_type&>(rhs.h_));
+  swap (h_.p_, rhs.h_.p_);
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>&
+recursive_wrapper<T, A>::operator=(recursive_wrapper&& rhs) noexcept {
+  swap (rhs);
+  return *this;
+}
+
+template <class T, class A>
+recursive_wrapper<T, A>&
+recursive_wrapper<T, A>::operator=(T&& rhs) {
+  if (h_.p_ == nullptr) { //moved from
+    h_.p_ = allocate (h_, std::move (rhs));
+    return *this;
+  }
+  get() = std::move (rhs);
+  return *this;
+}
+
+template <class T, class A>
+T* recursive_wrapper<T, A>::release() noexcept {
+  T* p = h_.p_;
+  h_.p_ = nullptr;
+  return p;
+}
+
+template <class T, class A>
+typename recursive_wrapper<T, A>::allocator_type
+recursive_wrapper<T, A>::get_allocator() const noexcept {
+  return h_;
 }
 
-template <typename T>
+template <class T, class A>
 inline void swap(
-  recursive_wrapper<T>& lhs, recursive_wrapper<T>& rhs) noexcept {
+  recursive_wrapper<T, A>& lhs, recursive_wrapper<T, A>& rhs) noexcept {
   lhs.swap(rhs);
 }
 
-template <typename T>
-T& recursive_wrapper<T>::get() { return *get_pointer(); }
+template <class T, class A>
+T& recursive_wrapper<T, A>::get() { return *get_pointer(); }
 
-template <typename T>
-T const& recursive_wrapper<T>::get() const { return *get_pointer(); }
+template <class T, class A>
+T const& recursive_wrapper<T, A>::get() const { return *get_pointer(); }
 
-template <typename T>
-T* recursive_wrapper<T>::get_pointer() { return p_; }
+template <class T, class A>
+T* recursive_wrapper<T, A>::get_pointer() { return h_.p_; }
 
-template <typename T>
-T const* recursive_wrapper<T>::get_pointer() const { return p_; }
+template <class T, class A>
+T const* recursive_wrapper<T, A>::get_pointer() const { return h_.p_; }
 
 }//namespace pgs
 
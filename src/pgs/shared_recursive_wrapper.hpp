@@ -0,0 +1,469 @@
+#if !defined(SHARED_RECURSIVE_WRAPPER_2A9F4C1E_7D35_4B60_9E1A_5C83D0F6B217_H)
+#  define SHARED_RECURSIVE_WRAPPER_2A9F4C1E_7D35_4B60_9E1A_5C83D0F6B217_H
+
+//! \file shared_recursive_wrapper.hpp
+//!
+//! \brief A workaround for the absence of recursive types in which
+//! copies share the wrapped value
+//!
+//! `recursive_wrapper<>` copies deep-copy the wrapped value. For
+//! persistent data structures (e.g. a tree from which an updated tree
+//! is built by `insert`) that means untouched sub-structures are
+//! duplicated on every update. A `shared_recursive_wrapper<>` holds
+//! its value in a heap allocated node carrying an intrusive reference
+//! count. Copies share the node which is destroyed when the last copy
+//! is.
+//!
+//! How the reference count is maintained is a policy : `atomic_count`
+//! (the default) for values that are shared across threads and
+//! `plain_count` for values that are not (it avoids an atomic
+//! read-modify-write on every copy and destruction). The policy also
+//! disposes of a node when its last reference goes (see
+//! `hash_cons<>` for a policy that does more than `delete` it).
+
+#include <pgs/recursive_wrapper.hpp>
+#include <pgs/worklist.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional> // std::hash<>
+#include <utility> // std::forward<>()
+
+namespace pgs {
+
+//! \brief A reference counting policy for `shared_recursive_wrapper<>`
+//! that is safe when copies are made and destroyed concurrently
+struct atomic_count {
+  //! \brief The type of the count
+  using value_type = std::atomic<std::size_t>;
+
+  //! \brief Count a new reference
+  static void increment (value_type& c) noexcept {
+    c.fetch_add (1, std::memory_order_relaxed);
+  }
+  //! \brief Discount a reference, `true` if it was the last
+  static bool decrement (value_type& c) noexcept {
+    return c.fetch_sub (1, std::memory_order_acq_rel) == 1;
+  }
+  //! \brief The number of references
+  static std::size_t load (value_type const& c) noexcept {
+    return c.load (std::memory_order_relaxed);
+  }
+  //! \brief Dispose of a node whose last reference has gone
+  template <class N>
+  static void dispose (N* p) noexcept {
+    delete p;
+  }
+};
+
+//! \brief A reference counting policy for `shared_recursive_wrapper<>`
+//! for values that are only ever accessed by one thread at a time
+struct plain_count {
+  //! \brief The type of the count
+  using value_type = std::size_t;
+
+  //! \brief Count a new reference
+  static void increment (value_type& c) noexcept {
+    ++c;
+  }
+  //! \brief Discount a reference, `true` if it was the last
+  static bool decrement (value_type& c) noexcept {
+    return --c == 0;
+  }
+  //! \brief The number of references
+  static std::size_t load (value_type const& c) noexcept {
+    return c;
+  }
+  //! \brief Dispose of a node whose last reference has gone
+  template <class N>
+  static void dispose (N* p) noexcept {
+    delete p;
+  }
+};
+
+//! \brief A metafunction to determine if the nodes of
+//! `shared_recursive_wrapper<T, C>`s cache the hash of their value
+//!
+//! The default is that they do not. Specialize this template (to
+//! derive from `std::true_type`, ahead of the first use of the
+//! wrapper) to have `std::hash<T>` computed once, when the node is
+//! constructed. Hashing a wrapper is then constant time and wrappers
+//! whose hashes differ compare unequal without their values being
+//! examined. As the values of nested wrappers are hashed by way of
+//! their own nodes, hashing a new node only looks one level down.
+//!
+//! \tparam T The type of value
+template <class T>
+struct cached_hash : std::false_type
+{};
+
+//! \cond
+template <class T, class C = atomic_count>
+class shared_recursive_wrapper; //fwd. decl.
+
+namespace detail {
+
+  //The heap allocated node of a `shared_recursive_wrapper<T, C>` :
+  //the reference count, the value and (if `cached_hash<T>`) the hash
+  //of the value
+  template <class T, class C, bool = cached_hash<T>::value>
+  struct shared_recursive_node {
+    typename C::value_type count;
+    T value;
+
+    template <class... Args>
+    explicit shared_recursive_node (Args&&... args)
+      : count {1}, value (std::forward<Args>(args)...)
+    {}
+  };
+
+  template <class T, class C>
+  struct shared_recursive_node<T, C, true> {
+    typename C::value_type count;
+    T value;
+    std::size_t hash;
+
+    template <class... Args>
+    explicit shared_recursive_node (Args&&... args)
+      : count {1}, value (std::forward<Args>(args)...)
+      , hash (std::hash<T>{}(value))
+    {}
+  };
+
+  //The hash of the value of a node
+  template <class T, class C>
+  std::size_t node_hash (shared_recursive_node<T, C, false> const& n) {
+    return std::hash<T>{}(n.value);
+  }
+
+  template <class T, class C>
+  std::size_t node_hash (shared_recursive_node<T, C, true> const& n) noexcept {
+    return n.hash;
+  }
+
+  //`true` if the values of two nodes are known to differ
+  template <class T, class C>
+  bool hashes_differ (
+      shared_recursive_node<T, C, false> const&
+    , shared_recursive_node<T, C, false> const&) noexcept {
+    return false;
+  }
+
+  template <class T, class C>
+  bool hashes_differ (
+      shared_recursive_node<T, C, true> const& l
+    , shared_recursive_node<T, C, true> const& r) noexcept {
+    return l.hash != r.hash;
+  }
+
+  //Compare the values of two nodes (a node is equal to itself, nodes
+  //whose cached hashes differ are not equal)
+  template <class T, class C, bool H>
+  bool shared_equal (
+      shared_recursive_node<T, C, H> const* l
+    , shared_recursive_node<T, C, H> const* r) {
+    return l == r
+      || (!hashes_differ (*l, *r) && boxed_equal (l->value, r->value));
+  }
+
+}//namespace detail
+//! \endcond
+
+//! \brief Partial specialization for types that are shared recursive
+//! wrappers
+template <class T, class C>
+struct is_recursive_wrapper<shared_recursive_wrapper<T, C>> : std::true_type
+{};
+
+//! \brief Partial specialization for types that are shared recursive
+//! wrappers
+template <class T, class C>
+struct recursive_wrapper_unwrap<shared_recursive_wrapper<T, C>> {
+  typedef T type; //!< The type of the value contained by a shared
+                  //!recursive wrapper
+};
+
+//! \class shared_recursive_wrapper
+//!
+//! \brief A `recursive_wrapper<>` whose copies share the wrapped
+//! value
+//!
+//! `shared_recursive_wrapper<T>` can be used wherever
+//! `recursive_wrapper<T>` can (as a case of a `sum_type<>` in
+//! particular). Copying is constant time (the reference count is
+//! incremented), assigning a `type` allocates a fresh node (other
+//! copies are not affected). The value is intended to be treated as
+//! immutable : modifying it through a non-`const` accessor is
+//! observable through every copy.
+//!
+//! A `shared_recursive_wrapper<>` that has been moved from no longer
+//! refers to a node. It may only be destroyed or assigned to.
+//!
+//! The destruction of nested wrappers is iterative (see
+//! `iterative_destruction<>`), as is, on request, their comparison
+//! (see `iterative_equality<>`).
+//!
+//! \tparam T The type of the wrapped value
+//! \tparam C The reference counting policy (`atomic_count` or
+//! `plain_count`)
+template <class T, class C>
+class shared_recursive_wrapper {
+public:
+  typedef T type;   //!< Alias `type` for `T`
+  typedef C count_policy; //!< Alias `count_policy` for `C`
+  //! The heap allocated node (reference count and value)
+  typedef detail::shared_recursive_node<T, C> node_type;
+
+private:
+  node_type* p_;
+
+  //Destruction of the node (deferred to the worklist unless
+  //`iterative_destruction<T>` has been specialized otherwise)
+  static void destroy (void* p, void const*) noexcept;
+  void destroy (std::true_type) noexcept;
+  void destroy (std::false_type) noexcept;
+
+public:
+
+  //! Forwarding ctor (heap allocates a node)
+  template <class... Args> shared_recursive_wrapper (Args&&... args);
+  //! Copy ctor (shares the node of `rhs`)
+  shared_recursive_wrapper (shared_recursive_wrapper const& rhs) noexcept;
+  //! Copy ctor (shares the node of `rhs`, preferred to the forwarding
+  //! ctor for non-`const` `rhs`)
+  shared_recursive_wrapper (shared_recursive_wrapper& rhs) noexcept;
+  //! Copy-construct from `type`
+  shared_recursive_wrapper (type const& rhs);
+  //! Move-construct from `shared_recursive_wrapper` (takes over the
+  //! node of `rhs`)
+  shared_recursive_wrapper (shared_recursive_wrapper&& rhs) noexcept;
+  //! Move-construct from `type`
+  shared_recursive_wrapper (type&& rhs);
+  //! Take over `p` (a node obtained from `release ()`)
+  shared_recursive_wrapper (adopt_t, node_type* p) noexcept;
+  //! Destructor (destroys the node if this is its last reference)
+  ~shared_recursive_wrapper ();
+
+  //! Copy-assign from `shared_recursive_wrapper`
+  shared_recursive_wrapper& operator= (
+    shared_recursive_wrapper const& rhs) noexcept;
+  //! Copy-assign from `type` (allocates a new node)
+  shared_recursive_wrapper& operator= (type const& rhs);
+  //! Move-assign from `shared_recursive_wrapper`
+  shared_recursive_wrapper& operator= (
+    shared_recursive_wrapper&& rhs) noexcept;
+  //! Move-assign from `type` (allocates a new node)
+  shared_recursive_wrapper& operator= (type&& rhs);
+
+  //! Swap with `shared_recursive_wrapper`
+  void swap (shared_recursive_wrapper& rhs) noexcept;
+
+  //! Relinquish the reference to the node (it is the caller's
+  //! responsibility to hand it back to a `shared_recursive_wrapper`
+  //! by way of the adopting constructor)
+  node_type* release () noexcept;
+
+  //! The number of `shared_recursive_wrapper`s referring to the node
+  std::size_t use_count () const noexcept;
+
+  //! The node (`nullptr` if moved from)
+  node_type const* node () const noexcept;
+
+  type& get (); //!< Accessor to the `type` instance
+  type const& get () const; //!< Accessor to the `type` instance
+  type* get_pointer (); //!< Accessor to the `type` instance
+  type const* get_pointer () const; //!< Accessor to the `type` instance
+};
+
+//! \brief `true` if contained values compare equal, false otherwise
+//! (values that are shared compare equal, and values whose cached
+//! hashes differ compare unequal, without being examined)
+template <class T, class C>
+bool operator== (
+    shared_recursive_wrapper<T, C> const& lhs
+  , shared_recursive_wrapper<T, C> const& rhs) {
+  return detail::shared_equal (lhs.node (), rhs.node ());
+}
+
+//! \brief `true` if contained values compare not equal, `false`
+//! otherwise
+template <class T, class C>
+bool operator!= (
+    shared_recursive_wrapper<T, C> const& lhs
+  , shared_recursive_wrapper<T, C> const& rhs) {
+  return !(lhs == rhs);
+}
+
+//! \brief `true` if the contained value of `lhs` is less than that of
+//! `rhs`, `false` otherwise (a value that is shared is not less than
+//! itself)
+template <class T, class C>
+bool operator< (
+    shared_recursive_wrapper<T, C> const& lhs
+  , shared_recursive_wrapper<T, C> const& rhs) {
+  return detail::boxed_less (lhs.get (), rhs.get ());
+}
+
+}//namespace pgs
+
+//! \cond
+namespace pgs {
+
+template <class T, class C>
+  template <class... Args>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (Args&&... args) :
+    p_ (new node_type (std::forward<Args>(args)...)) {
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (
+  shared_recursive_wrapper const& rhs) noexcept : p_ (rhs.p_) {
+  if (p_ != nullptr)
+    C::increment (p_->count);
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (
+  shared_recursive_wrapper& rhs) noexcept
+  : shared_recursive_wrapper (
+      static_cast<shared_recursive_wrapper const&>(rhs)) {
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (T const& rhs) :
+    p_ (new node_type (rhs)) {
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (
+  shared_recursive_wrapper&& rhs) noexcept : p_ (rhs.release ()) {
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (T&& rhs) :
+    p_ (new node_type (std::move (rhs))) {
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::shared_recursive_wrapper (
+  adopt_t, node_type* p) noexcept : p_ (p) {
+}
+
+template <class T, class C>
+void shared_recursive_wrapper<T, C>::destroy (
+  void* p, void const*) noexcept {
+  C::dispose (static_cast<node_type*>(p));
+}
+
+template <class T, class C>
+void shared_recursive_wrapper<T, C>::destroy (std::true_type) noexcept {
+  detail::destruction_worklist::destroy (p_, &destroy);
+}
+
+template <class T, class C>
+void shared_recursive_wrapper<T, C>::destroy (std::false_type) noexcept {
+  C::dispose (p_);
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>::~shared_recursive_wrapper () {
+  if (p_ != nullptr && C::decrement (p_->count))
+    destroy (iterative_destruction<T>{});
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>& shared_recursive_wrapper<T, C>::operator= (
+  shared_recursive_wrapper const& rhs) noexcept {
+  shared_recursive_wrapper (rhs).swap (*this);
+  return *this;
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>&
+  shared_recursive_wrapper<T, C>::operator= (T const& rhs) {
+  shared_recursive_wrapper (rhs).swap (*this);
+  return *this;
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>& shared_recursive_wrapper<T, C>::operator= (
+  shared_recursive_wrapper&& rhs) noexcept {
+  swap (rhs);
+  return *this;
+}
+
+template <class T, class C>
+shared_recursive_wrapper<T, C>&
+  shared_recursive_wrapper<T, C>::operator= (T&& rhs) {
+  shared_recursive_wrapper (std::move (rhs)).swap (*this);
+  return *this;
+}
+
+template <class T, class C>
+void shared_recursive_wrapper<T, C>::swap (
+  shared_recursive_wrapper& rhs) noexcept {
+  std::swap (p_, rhs.p_);
+}
+
+template <class T, class C>
+typename shared_recursive_wrapper<T, C>::node_type*
+shared_recursive_wrapper<T, C>::release () noexcept {
+  node_type* p = p_;
+  p_ = nullptr;
+  return p;
+}
+
+template <class T, class C>
+std::size_t shared_recursive_wrapper<T, C>::use_count () const noexcept {
+  return p_ == nullptr ? 0 : C::load (p_->count);
+}
+
+template <class T, class C>
+typename shared_recursive_wrapper<T, C>::node_type const*
+shared_recursive_wrapper<T, C>::node () const noexcept {
+  return p_;
+}
+
+template <class T, class C>
+inline void swap (
+    shared_recursive_wrapper<T, C>& lhs
+  , shared_recursive_wrapper<T, C>& rhs) noexcept {
+  lhs.swap (rhs);
+}
+
+template <class T, class C>
+T& shared_recursive_wrapper<T, C>::get () { return *get_pointer (); }
+
+template <class T, class C>
+T const& shared_recursive_wrapper<T, C>::get () const {
+  return *get_pointer ();
+}
+
+template <class T, class C>
+T* shared_recursive_wrapper<T, C>::get_pointer () { return &p_->value; }
+
+template <class T, class C>
+T const* shared_recursive_wrapper<T, C>::get_pointer () const {
+  return &p_->value;
+}
+
+}//namespace pgs
+
+//! \endcond
+
+namespace std {
+
+//! \brief Hash of a `shared_recursive_wrapper<>` (the hash of its
+//! value, cached if `pgs::cached_hash<T>`)
+template <class T, class C>
+struct hash<pgs::shared_recursive_wrapper<T, C>> {
+  //! \brief The hash of `w.get ()`
+  std::size_t operator () (
+    pgs::shared_recursive_wrapper<T, C> const& w) const {
+    return pgs::detail::node_hash (*w.node ());
+  }
+};
+
+}//namespace std
+
+#endif //!defined(SHARED_RECURSIVE_WRAPPER_2A9F4C1E_7D35_4B60_9E1A_5C83D0F6B217_H)
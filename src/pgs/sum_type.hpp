@@ -68,10 +68,22 @@
 //! x' for any value 'x'
 
 #  include <pgs/recursive_union.hpp>
+#  include <pgs/flat_union.hpp>
+#  include <pgs/tagged_pointer_union.hpp>
 
 #  include <cstddef>
+#  include <cstring>
 #  include <iostream>
+#  include <limits>
+#  include <memory>
+#  include <new>
 #  include <string>
+#  include <tuple>
+#  include <type_traits>
+#  if defined (__cpp_impl_three_way_comparison) \
+  && __cpp_impl_three_way_comparison >= 201907L
+#    include <compare>
+#  endif
 
 namespace pgs {
 
@@ -89,111 +101,496 @@ template <class... Ts> class sum_type;//fwd. decl
 //! \cond
 namespace detail {
 
-  template <std::size_t I, class T, class... Ts> 
-  struct index_of_impl;
+  template <class T>
+  bool case_less (T const&, T const&, std::true_type) {
+    return false;
+  }
 
-  template <std::size_t I, class T, class... Ts>
-  struct index_of_impl<I, T, T, Ts...> {
-    static auto const value = I;
+  template <class T>
+  bool case_less (T const& lhs, T const& rhs, std::false_type) {
+    return lhs < rhs;
+  }
+
+  //The ordering of the values of a case `T` of a sum (values that
+  //carry no data are equivalent, boxed values may be ordered
+  //iteratively, see `iterative_ordering<>`)
+  template <class T, bool = is_recursive_wrapper<T>::value>
+  struct sum_type_case_order {
+    template <class U>
+    static bool less (U const& lhs, U const& rhs) {
+      return case_less (lhs, rhs, std::is_empty<U>{});
+    }
   };
-  
-  template <std::size_t I, class T, class... Ts>
-  struct index_of_impl<I, T, recursive_wrapper<T>, Ts...> {
-    static auto const value = I;
+
+  template <class T>
+  struct sum_type_case_order<T, true> {
+    template <class U>
+    static bool less (U const& lhs, U const& rhs) {
+      return boxed_less (lhs, rhs);
+    }
   };
 
-  template <std::size_t I, class X, class T, class... Ts> 
-  struct index_of_impl<I, X, T, Ts...>{
-    static auto const value = index_of_impl<I + 1, X, Ts...>::value;
+  //Order the values at an index of two storages in constant time (as
+  //`recursive_union_dispatcher<>` does for `match`, by a table of
+  //function pointers, one per case)
+  template <class I, class... Ts>
+  struct sum_type_orderer;
+
+  template <std::size_t... Is, class... Ts>
+  struct sum_type_orderer<range<Is...>, Ts...> {
+    template <std::size_t I, class U>
+    static bool less_at (U const& u, U const& v) {
+      using type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+      return sum_type_case_order<type>::less (
+        union_ref<I> (u), union_ref<I> (v));
+    }
+
+    template <class U>
+    static bool less (std::size_t i, U const& u, U const& v) {
+      using entry_type = bool (*)(U const&, U const&);
+      static constexpr entry_type table[] = { &less_at<Is, U>... };
+      return table[i] (u, v);
+    }
   };
 
-  template <std::size_t I, class T, class... Ts>
-  struct type_at_impl : type_at_impl<I - 1, Ts...>
+  //Boxed cases whose node is owned by one value (and so may be reused)
+  template <class T>
+  struct is_unique_box : std::false_type
   {};
 
-  template <class T, class... Ts>
-  struct type_at_impl<0, T, Ts...> {
-    using type = recursive_wrapper_unwrap_t<T>;
-  };
+  template <class T, class A>
+  struct is_unique_box<recursive_wrapper<T, A>> : std::true_type
+  {};
+
+  //Construct `t` anew from `args...`
+  template <class T, class... Args>
+  void reconstruct (T& t, std::true_type, Args&&... args) noexcept {
+    t.~T ();
+    ::new (static_cast<void*>(&t)) T (std::forward<Args>(args)...);
+  }
+
+  template <class T, class... Args>
+  void reconstruct (T& t, std::false_type, Args&&... args) {
+    t = T (std::forward<Args>(args)...);
+  }
 
   struct sum_type_accessor {
 
     template <class... Ts>
     static constexpr std::size_t active_index (sum_type<Ts...> const& s) 
       noexcept {
-      return s.cons;
+      return s.repr.index ();
+    }
+
+    template <class... Ts>
+    static constexpr auto storage (sum_type<Ts...> const& s) noexcept
+      -> decltype ((s.repr.data)) {
+      return s.repr.data;
+    }
+
+    template <class... Ts>
+    static auto storage (sum_type<Ts...>& s) noexcept
+      -> decltype ((s.repr.data)) {
+      return s.repr.data;
     }
 
     template <class... Ts>
     static constexpr bool compare_at (
          std::size_t i, sum_type<Ts...> const& u, sum_type<Ts...> const& v) 
       noexcept {
-      return u.data.compare (i, v.data);
+      return u.repr.data.compare (i, v.repr.data);
+    }
+
+    template <class... Ts>
+    static std::size_t hash_at (std::size_t i, sum_type<Ts...> const& u) {
+      return u.repr.data.hash (i);
+    }
+
+    template <class... Ts>
+    static bool less_at (
+      std::size_t i, sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+      return sum_type_orderer<range_t<0, sizeof... (Ts) - 1>, Ts...>::less (
+        i, u.repr.data, v.repr.data);
     }
 
   };
 
+  //(A single expression, that `get` may be evaluated in a constant
+  //expression. An invalid access is reported out of line)
   template <std::size_t I, class... Ts>
   struct get_sum_type_element {
 
-    static auto get (sum_type<Ts...>& u) 
-      -> decltype (recursive_union_indexer<I, Ts...>::ref (u.data)) {
-      if (u.cons != I){
-        std::string message;
-        message += "Indexing with ";
-        message += std::to_string (I);
-        message += ", but the active index is ";
-        message += std::to_string (u.cons);
+    static constexpr auto get (sum_type<Ts...>& u) 
+      -> decltype (union_ref<I> (u.repr.data)) {
+      return u.repr.index () == I
+        ? union_ref<I> (u.repr.data)
+        : (invalid_access (I, u.repr.index ())
+         , union_ref<I> (u.repr.data));
+    }
+
+    static constexpr auto get (sum_type<Ts...> const& u) 
+      -> decltype (union_ref<I> (u.repr.data)) {
+      return u.repr.index () == I
+        ? union_ref<I> (u.repr.data)
+        : (invalid_access (I, u.repr.index ())
+         , union_ref<I> (u.repr.data));
+    }
+
+    static constexpr auto get (sum_type<Ts...>&& u) 
+      -> decltype (forward_case<sum_type<Ts...>, I> (union_ref<I> (u.repr.data))) {
+      return forward_case<sum_type<Ts...>, I> (get (u));
+    }
+
+    static auto get_if (sum_type<Ts...>* u) noexcept
+      -> decltype (std::addressof (union_ref<I> (u->repr.data))) {
+      return u != nullptr && u->repr.index () == I
+        ? std::addressof (union_ref<I> (u->repr.data))
+        : nullptr;
+    }
+
+    static auto get_if (sum_type<Ts...> const* u) noexcept
+      -> decltype (std::addressof (union_ref<I> (u->repr.data))) {
+      return u != nullptr && u->repr.index () == I
+        ? std::addressof (union_ref<I> (u->repr.data))
+        : nullptr;
+    }
+  };
+
+  template <std::size_t N>
+  using smallest_unsigned_t =
+    typename std::conditional<
+      N <= std::numeric_limits<unsigned char>::max (), unsigned char,
+    typename std::conditional<
+      N <= std::numeric_limits<unsigned short>::max (), unsigned short,
+    typename std::conditional<
+      N <= std::numeric_limits<unsigned int>::max (), unsigned int,
+      std::size_t>::type>::type>::type;
+
+  //The number of bytes at the start of a storage type that may be
+  //occupied by a case. The remainder is padding
+  template <class S>
+  struct storage_extent : std::integral_constant<std::size_t, sizeof (S)>
+  {};
+
+  template <class... Ts>
+  struct storage_extent<recursive_union<Ts...>>
+    : std::integral_constant<std::size_t, flat_union_extent<Ts...>::size>
+  {};
+
+  template <class... Ts>
+  struct storage_extent<flat_union<Ts...>>
+    : std::integral_constant<std::size_t, flat_union_extent<Ts...>::size>
+  {};
+
+  template <class S, class I>
+  struct index_fits_in_padding
+    : std::integral_constant<bool,
+        sizeof (S) - storage_extent<S>::value >= sizeof (I)>
+  {};
+
+  //Whether the operations of a storage type used to move a sum can
+  //throw
+  template <class S>
+  struct storage_is_nothrow_movable
+    : std::integral_constant<bool,
+        noexcept (std::declval<S&>().move (0, std::declval<S&&>()))
+     && noexcept (std::declval<S&>().destruct (0))>
+  {};
+
+  //Whether the operations of a storage type used to move-assign a
+  //sum can throw
+  template <class S>
+  struct storage_is_nothrow_move_assignable
+    : std::integral_constant<bool,
+        storage_is_nothrow_movable<S>::value
+     && noexcept (std::declval<S&>().move_assign (0, std::declval<S&&>()))>
+  {};
+
+  //Storage types that record the active index themselves
+  template <class S>
+  struct storage_holds_index : std::false_type
+  {};
+
+  template <class... Ts>
+  struct storage_holds_index<tagged_pointer_union<Ts...>> : std::true_type
+  {};
+
+  //The representation of a sum : storage and an active index. The
+  //index is a member following the storage...
+  template <class S, class I, bool = index_fits_in_padding<S, I>::value>
+  struct sum_type_repr {
+    S data;
+    I cons;
+
+    sum_type_repr ()
+    {}
+
+    template <class T, class... Args>
+    constexpr sum_type_repr (
+      std::size_t i, constructor<T> t, Args&&... args)
+      : data (t, std::forward<Args>(args)...), cons (static_cast<I>(i))
+    {}
 
-        throw invalid_sum_type_access{message};
+    constexpr std::size_t index () const noexcept {
+      return cons;
+    }
+
+    void set_index (std::size_t i) noexcept {
+      cons = static_cast<I>(i);
+    }
+  };
+
+  //...or, if there is room for it, is written into the padding at
+  //the end of the storage (by `memcpy` : not in constant expressions)
+  template <class S, class I>
+  struct sum_type_repr<S, I, true> {
+    S data;
+
+    static constexpr std::size_t offset = storage_extent<S>::value;
+
+    sum_type_repr ()
+    {}
+
+    template <class T, class... Args>
+    sum_type_repr (std::size_t i, constructor<T> t, Args&&... args)
+      : data (t, std::forward<Args>(args)...) {
+      set_index (i);
+    }
+
+    std::size_t index () const noexcept {
+      I i;
+      std::memcpy (
+        &i, reinterpret_cast<unsigned char const*>(&data) + offset, sizeof i);
+      return i;
+    }
+
+    void set_index (std::size_t i) noexcept {
+      I const j = static_cast<I>(i);
+      std::memcpy (
+        reinterpret_cast<unsigned char*>(&data) + offset, &j, sizeof j);
+    }
+  };
+
+  //...or is kept by the storage itself
+  template <class... Ts, class I>
+  struct sum_type_repr<tagged_pointer_union<Ts...>, I, false> {
+    tagged_pointer_union<Ts...> data;
+
+    sum_type_repr ()
+    {}
+
+    template <class T, class... Args>
+    sum_type_repr (std::size_t, constructor<T> t, Args&&... args)
+      : data (t, std::forward<Args>(args)...)
+    {}
+
+    std::size_t index () const noexcept {
+      return data.index ();
+    }
+
+    void set_index (std::size_t) noexcept {
+    }
+  };
+
+  //The copy, move and assignment of a sum (over its representation
+  //`sum_type_repr<S, I>`) : those of the representation when they are
+  //trivial for every case...
+  template <class S, class I, bool Trivial>
+  struct sum_type_copy : sum_type_repr<S, I> {
+    sum_type_copy ()
+    {}
+
+    template <class T, class... Args>
+    constexpr sum_type_copy (
+      std::size_t i, constructor<T> t, Args&&... args)
+      : sum_type_repr<S, I> (i, t, std::forward<Args>(args)...)
+    {}
+  };
+
+  //...else they dispatch on the active index. Assignment of a sum
+  //holding the same case assigns the active value
+  template <class S, class I>
+  struct sum_type_copy<S, I, false> : sum_type_repr<S, I> {
+    sum_type_copy ()
+    {}
+
+    template <class T, class... Args>
+    constexpr sum_type_copy (
+      std::size_t i, constructor<T> t, Args&&... args)
+      : sum_type_repr<S, I> (i, t, std::forward<Args>(args)...)
+    {}
+
+    sum_type_copy (sum_type_copy const& other) : sum_type_repr<S, I> () {
+      std::size_t const cons = other.index ();
+      this->data.copy (cons, other.data);
+      this->set_index (cons);
+    }
+
+    sum_type_copy (sum_type_copy&& other)
+      noexcept (storage_is_nothrow_movable<S>::value)
+      : sum_type_repr<S, I> () {
+      std::size_t const cons = other.index ();
+      this->data.move (cons, std::move (other.data));
+      this->set_index (cons);
+    }
+
+    sum_type_copy& operator= (sum_type_copy const& other) {
+      if (std::addressof (other) == this)
+        return *this;
+
+      std::size_t const cons = other.index ();
+      if (cons == this->index ()) {
+        this->data.assign (cons, other.data);
+        return *this;
       }
-      return recursive_union_indexer<I, Ts...>::ref (u.data);
+      this->data.destruct (this->index ());
+      this->data.copy (cons, other.data);
+      this->set_index (cons);
+
+      return *this;
     }
 
-    static auto get (sum_type<Ts...> const& u) 
-      -> decltype (recursive_union_indexer<I, Ts...>::ref (u.data))
-    {
-      if (u.cons != I){
-        std::string message;
-        message += "Indexing with ";
-        message += std::to_string (I);
-        message += ", but the active index is ";
-        message += std::to_string (u.cons);
-
-        throw invalid_sum_type_access{message};
+    sum_type_copy& operator= (sum_type_copy&& other)
+      noexcept (storage_is_nothrow_move_assignable<S>::value) {
+      if (std::addressof (other) == this)
+        return *this;
+
+      std::size_t const cons = other.index ();
+      if (cons == this->index ()) {
+        this->data.move_assign (cons, std::move (other.data));
+        return *this;
       }
-      return recursive_union_indexer<I, Ts...>::ref (u.data);
+      this->data.destruct (this->index ());
+      this->data.move (cons, std::move (other.data));
+      this->set_index (cons);
+
+      return *this;
+    }
+  };
+
+  //The destruction of a sum : that of the representation when it is
+  //trivial for every case...
+  template <class S, class I, bool TrivialDestructor, bool TrivialCopy>
+  struct sum_type_value : sum_type_copy<S, I, TrivialCopy> {
+    sum_type_value ()
+    {}
+
+    template <class T, class... Args>
+    constexpr sum_type_value (
+      std::size_t i, constructor<T> t, Args&&... args)
+      : sum_type_copy<S, I, TrivialCopy> (i, t, std::forward<Args>(args)...)
+    {}
+  };
+
+  //...else it destroys the active value
+  template <class S, class I, bool TrivialCopy>
+  struct sum_type_value<S, I, false, TrivialCopy>
+    : sum_type_copy<S, I, TrivialCopy> {
+    sum_type_value ()
+    {}
+
+    template <class T, class... Args>
+    constexpr sum_type_value (
+      std::size_t i, constructor<T> t, Args&&... args)
+      : sum_type_copy<S, I, TrivialCopy> (i, t, std::forward<Args>(args)...)
+    {}
+
+    sum_type_value (sum_type_value const&) = default;
+    sum_type_value (sum_type_value&&) = default;
+    sum_type_value& operator= (sum_type_value const&) = default;
+    sum_type_value& operator= (sum_type_value&&) = default;
+
+    ~sum_type_value () {
+      this->data.destruct (this->index ());
     }
   };
 
 }//namespace detail
 //! \endcond
 
-//! \brief A metafunction to compute the index `I` of a type `T` in a
-//! sequence `Ts`
+//! \brief A metafunction to compute the storage type of a
+//! `sum_type<Ts...>`
 //!
-//! \tparam T The type for which we desire its index in `Ts`
-//! \tparam Ts A parameter pack containing `T`
-template <class T, class... Ts>
-struct index_of {
-  //!\brief The index of `T` in `Ts...`
-  static constexpr auto const value = 
-    detail::index_of_impl<0u, T, Ts...>::value;
+//! The storage is a `tagged_pointer_union<Ts...>` when every case is
+//! either a `recursive_wrapper<>` or carries no data (see
+//! `is_tagged_pointer_representable<>`) and a `recursive_union<Ts...>`
+//! otherwise, unless this template is specialized. For example,
+//! specializing it to produce `flat_union<Ts...>` selects the flat
+//! (single buffer, table driven) representation for the sum over
+//! `Ts...`
+//!
+//! \tparam Ts The cases of the sum
+template <class... Ts>
+struct sum_type_storage {
+  //! \brief The storage type
+  using type = typename std::conditional<
+      is_tagged_pointer_representable<Ts...>::value
+    , tagged_pointer_union<Ts...>
+    , recursive_union<Ts...>>::type;
 };
 
-//! \brief Get the type at a given index in a variadic type list
-template <std::size_t I,  class... Ts>
-using type_at = typename detail::type_at_impl<I, Ts...>::type;
+//! \brief A metafunction describing the layout of a
+//! `sum_type<Ts...>`
+//!
+//! The active index is held in the smallest unsigned type that can
+//! represent every index of `Ts...`. When the storage has enough
+//! trailing padding (the largest case is smaller than the storage
+//! rounded up to its alignment) the index is written there, else it
+//! follows the storage. A storage type that records the index itself
+//! (`tagged_pointer_union<>`) takes no room for it at all.
+//!
+//! An index in padding is read and written through `std::memcpy`, so
+//! a sum with that layout (`index_in_padding`) can't be constructed or
+//! inspected in a constant expression, even if all of `Ts...` are
+//! literal types. Such a sum trades `constexpr` for its smaller size.
+//!
+//! \tparam Ts The cases of the sum
+template <class... Ts>
+struct sum_type_layout {
+  //! \brief The storage type (see `sum_type_storage<>`)
+  using storage_type = typename sum_type_storage<Ts...>::type;
+  //! \brief The type of the active index
+  using index_type = detail::smallest_unsigned_t<sizeof... (Ts) - 1>;
+  //! \brief `true` if the active index lives in the padding of the
+  //! storage
+  static constexpr bool index_in_padding =
+    detail::index_fits_in_padding<storage_type, index_type>::value;
+  //! \brief `true` if the active index is recorded by the storage
+  static constexpr bool index_in_storage =
+    detail::storage_holds_index<storage_type>::value;
+  //! \brief The size of a `sum_type<Ts...>`
+  static constexpr std::size_t size =
+    sizeof (detail::sum_type_repr<storage_type, index_type>);
+};
 
 //! \class sum_type
 //!
 //! \brief A type modeling "sums with constructors" as used in
 //! functional programming
+//!
+//! The destructor of a `sum_type<Ts...>` is trivial if those of all
+//! of `Ts...` are, and its copy, move and assignment are trivial
+//! (the sum is trivially copyable) if those of all of `Ts...` are.
+//!
+//! Deep values : destroying a sum of boxed cases takes constant stack
+//! depth however deep the value (see `iterative_destruction<>`).
+//! Copying it, comparing it for equality and ordering it do not :
+//! by default they recurse once per nested node, so a long enough
+//! list or deep enough tree overflows the stack. Each is made
+//! iterative only for the types that opt in (see `iterative_copy<>`,
+//! `iterative_equality<>` and `iterative_ordering<>`), as doing so
+//! places requirements on their copy constructor and operators that
+//! cannot be checked.
 template <class... Ts>
 class sum_type {
 private:
-  std::size_t cons;
-  recursive_union<Ts...> data;
+  using layout_type = sum_type_layout<Ts...>;
+
+  detail::sum_type_value<
+      typename layout_type::storage_type
+    , typename layout_type::index_type
+    , and_<detail::is_trivially_destructible_case<Ts>...>::value
+    , and_<detail::is_trivially_copyable_case<Ts>...>::value> repr;
 
 private:
   friend struct detail::sum_type_accessor;
@@ -202,30 +599,101 @@ private:
 
 public:
 
-  //! Ctor
+  //! \brief Ctor
+  //!
+  //! The construction of a sum may be evaluated in a constant
+  //! expression if that of the case is, the storage is a
+  //! `recursive_union<>` and the active index follows it (is not in
+  //! its padding). A sum of literal cases that are trivially
+  //! destructible is a literal type.
   template <class T, class... Args>
-  explicit sum_type (constructor<T> t, Args&&... args);
+  constexpr explicit sum_type (constructor<T> t, Args&&... args);
 
   sum_type () = delete;
-  sum_type (sum_type const& other); //!< Copy ctor
-  sum_type (sum_type&& other); //!< Move ctor
-
-  ~sum_type(); //!< Dtor
-
-  //! Copy-assign operator
-  sum_type& operator= (sum_type const& other);
-
-  //! Move-assign operator
-  sum_type& operator= (sum_type&& other);
-
-  //! `match` function, `const` overoad
-  template <class R, class... Fs> R match(Fs&&... fs) const;
+  sum_type (sum_type const& other) = default; //!< Copy ctor
+
+  //! \brief Move ctor
+  //!
+  //! A boxed value changes hands : `other` keeps its active index but
+  //! no longer has a node. Until it is given a value again (by
+  //! assignment or `emplace<>`), `other` may only be destroyed : it
+  //! may not be copied, compared, hashed, matched or accessed.
+  sum_type (sum_type&& other) = default;
+
+  ~sum_type() = default; //!< Dtor
+
+  //! \brief Copy-assign operator
+  //!
+  //! If `other` holds the active case, its value is copy-assigned to
+  //! the active value (for a `recursive_wrapper<>`, in the node
+  //! already allocated). Else the active value is destroyed and a
+  //! copy of the value of `other` constructed.
+  sum_type& operator= (sum_type const& other) = default;
+
+  //! \brief Move-assign operator
+  //!
+  //! If `other` holds the active case, its value is move-assigned to
+  //! the active value. Else the active value is destroyed and the
+  //! value of `other` moved in. Either way, `other` is left as by the
+  //! move ctor (it may only be destroyed, assigned to or emplaced
+  //! into). A sum that has been moved from may be assigned to.
+  sum_type& operator= (sum_type&& other) = default;
+
+  //! \brief Make the case at index `I`, constructed from `args...`,
+  //! the active case
+  //!
+  //! The value is constructed in place, no temporary sum is made.
+  //!
+  //! If the case at index `I` is active and is a `recursive_wrapper<>`
+  //! that has a node (a sum that has been moved from has none), the
+  //! node is reused : the value is destroyed and constructed anew
+  //! in place if that cannot throw, else a new value is constructed
+  //! and move-assigned to it (the guarantee is that of the move
+  //! assignment).
+  //!
+  //! Otherwise, if constructing the case cannot throw, the active
+  //! value is destroyed and the case constructed in its place. Else
+  //! the case (its node, for a boxed case) is constructed first and
+  //! the active value destroyed only once that has succeeded (the
+  //! strong guarantee), then moved into place (`std::terminate ()`
+  //! is called should that move throw).
+  //!
+  //! `args...` must not refer to the active value (it may be
+  //! destroyed before they are used).
+  //!
+  //! \returns A reference to the new value
+  template <std::size_t I, class... Args>
+  type_at<I, Ts...>& emplace (Args&&... args);
+
+  //! \brief Make the case `T`, constructed from `args...`, the active
+  //! case (see `emplace<I>`)
+  //!
+  //! \returns A reference to the new value
+  template <class T, class... Args>
+  T& emplace (Args&&... args);
+
+  //! \brief `match` function, `const` overoad
+  //!
+  //! May be evaluated in a constant expression if the sum may be
+  //! constructed in one (see the ctor) and the applicable closure is
+  //! a `constexpr` call.
+  template <class R, class... Fs> constexpr R match(Fs&&... fs) const&;
   //! `match` function, non-`const` overoad
-  template <class R, class... Fs> R match(Fs&&... fs);
+  template <class R, class... Fs> R match(Fs&&... fs) &;
+  //! \brief `match` function, rvalue overoad
+  //!
+  //! The active value is passed to its handler as an rvalue (a
+  //! `T&&`, dereferenced through a `recursive_wrapper<>` if needs be)
+  //! : the handler may move from it. The value of a
+  //! `shared_recursive_wrapper<>` is passed as a `T const&` (its node
+  //! may be shared by other sums or interned, see `rvalue_type_at<>`).
+  template <class R, class... Fs> R match(Fs&&... fs) &&;
   //! `match` procedure, `const` overoad
-  template <class... Fs> void match(Fs&&... fs) const;
+  template <class... Fs> void match(Fs&&... fs) const&;
   //! `match` procedure, non-`const` overoad
-  template <class... Fs> void match(Fs&&... fs);
+  template <class... Fs> void match(Fs&&... fs) &;
+  //! `match` procedure, rvalue overoad
+  template <class... Fs> void match(Fs&&... fs) &&;
 
   //! The currently active `v` is a `T`?
   template<class T>
@@ -234,102 +702,169 @@ public:
   //! The currently active `v` is at position `I`?
   template<std::size_t I>
   constexpr bool is_type_at () const noexcept;
+
+private:
+  //The stored type (possibly a recursive wrapper) of the case at
+  //index `I`
+  template <std::size_t I>
+  using case_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+  template <std::size_t I, class... Args>
+  void emplace_active (std::true_type, Args&&... args);
+  template <std::size_t I, class... Args>
+  void emplace_active (std::false_type, Args&&... args);
+  template <std::size_t I, class... Args>
+  void emplace_case (std::true_type, Args&&... args);
+  template <std::size_t I, class... Args>
+  void emplace_case (std::false_type, Args&&... args);
+  template <std::size_t I, class... Args>
+  void construct_case (Args&&... args) noexcept;
 };
 
 //! \cond
-template <class... Ts>
-sum_type<Ts...>::sum_type (sum_type const& other) : cons (other.cons) {
-  //std::cout << "sum_type::sum_type (sum_type const &)\n";
-  data.copy (cons, other.data);
-}
-
-template <class... Ts>
-sum_type<Ts...>::sum_type (sum_type&& other) : cons (other.cons) {
-  //std::cout << "sum_type::sum_type (sum_type&&)\n";
-  data.move (cons, std::move (other.data));
-}
-
 template <class... Ts>
   template <class T, class... Args>
-  sum_type<Ts...>::sum_type (constructor<T> t, Args&&... args)
-  : data (t, std::forward<Args>(args)...), cons (index_of<T, Ts...>::value){
+  constexpr sum_type<Ts...>::sum_type (constructor<T> t, Args&&... args)
+  : repr (index_of<T, Ts...>::value, t, std::forward<Args>(args)...) {
   //std::cout << "sum_type<Ts...>::sum_type (constructor<T> t, Args&&... args)\n";
 }
 
-template <class... Ts>
-sum_type<Ts...>::~sum_type() {
-  data.destruct (cons);
-}
-
-template <class... Ts>
-sum_type<Ts...>& sum_type<Ts...>::operator= (sum_type const& other) {
-  if (std::addressof (other) == this)
-    return *this;
-
-  data.destruct (cons);
-  cons = other.cons;
-  data.copy (cons, other.data);
-
-  return *this;
-}
-
-template <class... Ts>
-sum_type<Ts...>& sum_type<Ts...>::operator= (sum_type&& other) {
-  if (std::addressof (other) == this)
-    return *this;
-
-  data.destruct (cons);
-  cons = other.cons;
-  data.move (cons, std::move (other.data));
-
-  return *this;
+template<class... Ts>
+  template <class R, class... Fs>
+constexpr R sum_type<Ts...>::match(Fs&&... fs) const& {
+  return recursive_union_dispatcher<
+      R, range_t<0, sizeof... (Ts) - 1>, Ts...>::visit (
+               repr.data, repr.index (), std::forward<Fs>(fs)...);
 }
 
 template<class... Ts>
   template <class R, class... Fs>
-R sum_type<Ts...>::match(Fs&&... fs) const {
+R sum_type<Ts...>::match(Fs&&... fs) & {
   using indicies = range_t<0, sizeof... (Ts) - 1>;
-  return recursive_union_visitor<R, indicies, Ts...>::visit (
-               data, cons, std::forward<Fs>(fs)...);
+
+  return recursive_union_dispatcher<R, indicies, Ts...>::visit (
+                repr.data, repr.index (), std::forward<Fs>(fs)...);
 }
 
 template<class... Ts>
   template <class R, class... Fs>
-R sum_type<Ts...>::match(Fs&&... fs) {
+R sum_type<Ts...>::match(Fs&&... fs) && {
   using indicies = range_t<0, sizeof... (Ts) - 1>;
 
-  return recursive_union_visitor<R, indicies, Ts...>::visit (
-                data, cons, std::forward<Fs>(fs)...);
+  return recursive_union_dispatcher<R, indicies, Ts...>::visit (
+     std::move (repr.data), repr.index (), std::forward<Fs>(fs)...);
 }
 
 template<class... Ts>
   template <class... Fs>
-void sum_type<Ts...>::match(Fs&&... fs) const {
+void sum_type<Ts...>::match(Fs&&... fs) const& {
   using indicies = range_t<0, sizeof... (Ts) - 1>;
 
-  recursive_union_visitor<void, indicies, Ts...>::visit (
-                data, cons, std::forward<Fs>(fs)...);
+  recursive_union_dispatcher<void, indicies, Ts...>::visit (
+                repr.data, repr.index (), std::forward<Fs>(fs)...);
 }
 
 template<class... Ts>
   template <class... Fs>
-void sum_type<Ts...>::match(Fs&&... fs) {
+void sum_type<Ts...>::match(Fs&&... fs) & {
   using indicies = range_t<0, sizeof... (Ts) - 1>;
    
-  recursive_union_visitor<void, indicies, Ts...>::visit (
-                data, cons, std::forward<Fs>(fs)...);
+  recursive_union_dispatcher<void, indicies, Ts...>::visit (
+                repr.data, repr.index (), std::forward<Fs>(fs)...);
+}
+
+template<class... Ts>
+  template <class... Fs>
+void sum_type<Ts...>::match(Fs&&... fs) && {
+  using indicies = range_t<0, sizeof... (Ts) - 1>;
+
+  recursive_union_dispatcher<void, indicies, Ts...>::visit (
+     std::move (repr.data), repr.index (), std::forward<Fs>(fs)...);
+}
+
+template <class... Ts>
+  template <std::size_t I, class... Args>
+type_at<I, Ts...>& sum_type<Ts...>::emplace (Args&&... args) {
+  if (repr.index () == I)
+    emplace_active<I> (detail::is_unique_box<case_type<I>>{}
+      , std::forward<Args>(args)...);
+  else
+    emplace_case<I> (std::integral_constant<bool,
+        !is_recursive_wrapper<case_type<I>>::value
+      && std::is_nothrow_constructible<type_at<I, Ts...>, Args&&...>::value>{}
+      , std::forward<Args>(args)...);
+  return union_ref<I> (repr.data);
+}
+
+template <class... Ts>
+  template <class T, class... Args>
+T& sum_type<Ts...>::emplace (Args&&... args) {
+  return emplace<index_of<T, Ts...>::value> (std::forward<Args>(args)...);
+}
+
+//The active case is a `recursive_wrapper<>` : reuse its node (if it
+//has one, a sum that has been moved from has none)
+template <class... Ts>
+  template <std::size_t I, class... Args>
+void sum_type<Ts...>::emplace_active (std::true_type, Args&&... args) {
+  using T = type_at<I, Ts...>;
+  T* const p = union_ptr<I> (repr.data);
+  if (p == nullptr) {
+    emplace_case<I> (std::false_type{}, std::forward<Args>(args)...);
+    return;
+  }
+  detail::reconstruct (*p
+    , std::integral_constant<bool,
+        std::is_nothrow_constructible<T, Args&&...>::value>{}
+    , std::forward<Args>(args)...);
+}
+
+template <class... Ts>
+  template <std::size_t I, class... Args>
+void sum_type<Ts...>::emplace_active (std::false_type, Args&&... args) {
+  emplace_case<I> (std::integral_constant<bool,
+      !is_recursive_wrapper<case_type<I>>::value
+    && std::is_nothrow_constructible<type_at<I, Ts...>, Args&&...>::value>{}
+    , std::forward<Args>(args)...);
+}
+
+//Constructing the case cannot throw : destroy and construct in place
+template <class... Ts>
+  template <std::size_t I, class... Args>
+void sum_type<Ts...>::emplace_case (std::true_type, Args&&... args) {
+  repr.data.destruct (repr.index ());
+  construct_case<I> (std::forward<Args>(args)...);
+}
+
+//Constructing the case can throw : construct it (its node, if boxed)
+//ahead of destroying the active value
+template <class... Ts>
+  template <std::size_t I, class... Args>
+void sum_type<Ts...>::emplace_case (std::false_type, Args&&... args) {
+  case_type<I> staged (std::forward<Args>(args)...);
+  repr.data.destruct (repr.index ());
+  construct_case<I> (std::move (staged));
+}
+
+template <class... Ts>
+  template <std::size_t I, class... Args>
+void sum_type<Ts...>::construct_case (Args&&... args) noexcept {
+  using storage_type = typename layout_type::storage_type;
+  ::new (static_cast<void*>(&repr.data)) storage_type (
+    constructor<type_at<I, Ts...>>{}, std::forward<Args>(args)...);
+  repr.set_index (I);
 }
 
 template <class... Ts>
   template <class T>
 constexpr bool sum_type<Ts...>::is () const noexcept {
-  return cons == index_of<T, Ts...>::value;
+  return repr.index () == index_of<T, Ts...>::value;
 }
 
 template <class... Ts>
   template <std::size_t I>
 constexpr bool sum_type<Ts...>::is_type_at () const noexcept {
-  return cons == I;
+  return repr.index () == I;
 }
 //! \endcond
 
@@ -345,6 +880,15 @@ constexpr T const& get (sum_type<Ts...> const& s);
 template<class T, class ... Ts>
 constexpr T& get (sum_type<Ts...>& s);
 
+//! \brief Attempt to get at the value contained in a sum indexed by
+//! type, as an rvalue (that may be moved from) or, if the case is a
+//! `shared_recursive_wrapper<>`, as a `const` reference (see
+//! `rvalue_type_at<>`)
+
+template<class T, class ... Ts>
+constexpr rvalue_type_at<index_of<T, Ts...>::value, Ts...>
+  get (sum_type<Ts...>&& s);
+
 //! \cond
 
 template<class T, class ... Ts>
@@ -359,6 +903,13 @@ constexpr T& get (sum_type<Ts...>& s) {
     index_of<T, Ts...>::value, Ts...>::get (s);
 }
 
+template<class T, class ... Ts>
+constexpr rvalue_type_at<index_of<T, Ts...>::value, Ts...>
+  get (sum_type<Ts...>&& s) {
+  return detail::get_sum_type_element<
+    index_of<T, Ts...>::value, Ts...>::get (static_cast<sum_type<Ts...>&&> (s));
+}
+
 //! \endcond
 
 //! \brief Attempt to get at the value contained in a sum
@@ -371,6 +922,14 @@ constexpr type_at<I, Ts...>& get (sum_type<Ts...>& s);
 template <std::size_t I, class... Ts>
 constexpr type_at<I, Ts...> const& get (sum_type<Ts...> const& s);
 
+//! \brief Attempt to get at the value contained in a sum, as an
+//! rvalue (that may be moved from) or, if the case is a
+//! `shared_recursive_wrapper<>`, as a `const` reference (see
+//! `rvalue_type_at<>`)
+
+template <std::size_t I, class... Ts>
+constexpr rvalue_type_at<I, Ts...> get (sum_type<Ts...>&& s);
+
 //! \cond
 template <std::size_t I, class... Ts>
 inline constexpr type_at<I, Ts...>& get (sum_type<Ts...>& s) {
@@ -381,6 +940,57 @@ template <std::size_t I, class... Ts>
 inline constexpr type_at<I, Ts...> const& get (sum_type<Ts...> const& s) {
   return detail::get_sum_type_element<I, Ts...>::get (s);
 }
+
+template <std::size_t I, class... Ts>
+inline constexpr rvalue_type_at<I, Ts...> get (sum_type<Ts...>&& s) {
+  return detail::get_sum_type_element<I, Ts...>::get (static_cast<sum_type<Ts...>&&> (s));
+}
+//! \endcond
+
+//! \brief A pointer to the value contained in `*s` if it is a `T`,
+//! else (or if `s` is null) `nullptr`
+//!
+//! Unlike `get`, this does not report an invalid access.
+template <class T, class... Ts>
+T* get_if (sum_type<Ts...>* s) noexcept;
+
+//! \brief A pointer to the value contained in `*s` if it is a `T`,
+//! else (or if `s` is null) `nullptr`
+template <class T, class... Ts>
+T const* get_if (sum_type<Ts...> const* s) noexcept;
+
+//! \brief A pointer to the value contained in `*s` if the active
+//! index is `I`, else (or if `s` is null) `nullptr`
+template <std::size_t I, class... Ts>
+type_at<I, Ts...>* get_if (sum_type<Ts...>* s) noexcept;
+
+//! \brief A pointer to the value contained in `*s` if the active
+//! index is `I`, else (or if `s` is null) `nullptr`
+template <std::size_t I, class... Ts>
+type_at<I, Ts...> const* get_if (sum_type<Ts...> const* s) noexcept;
+
+//! \cond
+template <class T, class... Ts>
+inline T* get_if (sum_type<Ts...>* s) noexcept {
+  return detail::get_sum_type_element<
+    index_of<T, Ts...>::value, Ts...>::get_if (s);
+}
+
+template <class T, class... Ts>
+inline T const* get_if (sum_type<Ts...> const* s) noexcept {
+  return detail::get_sum_type_element<
+    index_of<T, Ts...>::value, Ts...>::get_if (s);
+}
+
+template <std::size_t I, class... Ts>
+inline type_at<I, Ts...>* get_if (sum_type<Ts...>* s) noexcept {
+  return detail::get_sum_type_element<I, Ts...>::get_if (s);
+}
+
+template <std::size_t I, class... Ts>
+inline type_at<I, Ts...> const* get_if (sum_type<Ts...> const* s) noexcept {
+  return detail::get_sum_type_element<I, Ts...>::get_if (s);
+}
 //! \endcond
 
 template <class... Ts>
@@ -396,6 +1006,70 @@ bool operator != (sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
   return ! (u == v);
 }
 
+//! \brief `true` if `u` is ordered before `v`
+//!
+//! Sums are ordered by active index and then by active value (by
+//! `operator<` of the case, cases that carry no data are equivalent).
+//! The values are reached in constant time, as by `match`. The
+//! ordering of nested recursive values recurses unless their type
+//! opts in to `iterative_ordering<>` (the ordering of lists can, that
+//! of trees recurses to their depth).
+template <class... Ts>
+bool operator < (sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+  std::size_t m = detail::sum_type_accessor::active_index (u);
+  std::size_t n = detail::sum_type_accessor::active_index (v);
+
+  return m != n ? m < n : detail::sum_type_accessor::less_at (m, u, v);
+}
+
+//! \brief `true` if `u` is ordered after `v`
+template <class... Ts>
+bool operator > (sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+  return v < u;
+}
+
+//! \brief `true` if `u` is not ordered after `v`
+template <class... Ts>
+bool operator <= (sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+  return ! (v < u);
+}
+
+//! \brief `true` if `u` is not ordered before `v`
+template <class... Ts>
+bool operator >= (sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+  return ! (u < v);
+}
+
+#  if defined (__cpp_impl_three_way_comparison) \
+  && __cpp_impl_three_way_comparison >= 201907L
+//! \brief The ordering of `u` and `v` (see `operator<`)
+template <class... Ts>
+std::weak_ordering operator <=> (
+  sum_type<Ts...> const& u, sum_type<Ts...> const& v) {
+  return u < v ? std::weak_ordering::less
+    : v < u ? std::weak_ordering::greater : std::weak_ordering::equivalent;
+}
+#  endif
+
 }//namespace pgs
 
+namespace std {
+
+//! \brief Hash of a `sum_type<>`
+//!
+//! Combines the active index and the hash of the active value (see
+//! `hash.hpp`). Every case (other than those carrying no data) must
+//! be hashable.
+template <class... Ts>
+struct hash<pgs::sum_type<Ts...>> {
+  //! \brief The hash of `u`
+  std::size_t operator () (pgs::sum_type<Ts...> const& u) const {
+    std::size_t const i = pgs::detail::sum_type_accessor::active_index (u);
+    return pgs::hash_combine (
+      i, pgs::detail::sum_type_accessor::hash_at (i, u));
+  }
+};
+
+}//namespace std
+
 #endif //!defined(SUM_F8718480_DC1C_4410_84C0_DDDA2C2FED94_H)
@@ -0,0 +1,426 @@
+#if !defined (TAGGED_POINTER_UNION_0C3D7E9A_61F2_4E4B_8D0B_7A2E5C94F1D3_H)
+#  define TAGGED_POINTER_UNION_0C3D7E9A_61F2_4E4B_8D0B_7A2E5C94F1D3_H
+
+//! \file tagged_pointer_union.hpp
+//!
+//! \brief A type modeling a union of boxed and empty cases in a
+//! single pointer.
+//!
+//! Sums like `sum_type<recursive_wrapper<cons_t<T>>, nil_t>` (a list)
+//! or `sum_type<empty_t, recursive_wrapper<node_t<K, V>>>` (a tree)
+//! have cases that are either held on the heap or carry no data at
+//! all. Such sums can be represented by one machine word : the
+//! address of the heap allocated value (if any) with the active index
+//! in its low bits (which are zero since the allocation is suitably
+//! aligned).
+
+#  include <pgs/recursive_union.hpp>
+
+#  include <cassert>
+#  include <cstddef>
+#  include <cstdint>
+#  include <new>
+#  include <tuple>
+#  include <type_traits>
+
+namespace pgs {
+
+  //! \cond
+  namespace detail {
+
+    constexpr std::size_t tagged_pointer_bits (
+      std::size_t n, std::size_t acc = 0) {
+      return (std::size_t{1} << acc) >= n
+        ? acc : tagged_pointer_bits (n, acc + 1);
+    }
+
+    //A case that carries no data
+    template <class T>
+    struct is_tagged_pointer_empty_case
+      : std::integral_constant<bool,
+          std::is_empty<T>::value && std::is_trivially_destructible<T>::value>
+    {};
+
+    //A case that is boxed or carries no data
+    template <class T>
+    struct is_tagged_pointer_case : is_tagged_pointer_empty_case<T>
+    {};
+
+    //A boxed case can only be tagged if nothing but the pointer needs
+    //to be kept (its allocator is stateless) and the low bits of the
+    //pointer are known to be zero (its allocator aligns as `operator
+    //new` does)
+    template <class T, class A>
+    struct is_tagged_pointer_case<recursive_wrapper<T, A>>
+      : and_<
+            is_stateless_allocator<
+              typename recursive_wrapper<T, A>::allocator_type>
+          , is_max_aligned_allocator<
+              typename recursive_wrapper<T, A>::allocator_type>>
+    {};
+
+    //Shared nodes are allocated by `operator new`
+    template <class T, class C>
+    struct is_tagged_pointer_case<shared_recursive_wrapper<T, C>>
+      : std::true_type
+    {};
+
+    //The operations on a case `T` of a `tagged_pointer_union<>`
+    //(entries of the tables of `tagged_pointer_union<>`). This
+    //definition handles cases that carry no data : the value is
+    //notionally located at the address of the word (no bits of which
+    //it occupies).
+    template <class T>
+    struct tagged_pointer_case {
+      template <class... Args>
+      static std::uintptr_t make (
+        std::uintptr_t& w, std::size_t i, Args&&... args) {
+        new (&w) T (std::forward<Args>(args)...);
+        return i;
+      }
+      static void copy (std::uintptr_t& w, std::uintptr_t const& src
+                      , std::size_t i, std::uintptr_t mask) {
+        w = make (w, i, ref (src, mask));
+      }
+      static void assign (std::uintptr_t&, std::uintptr_t const&
+                        , std::size_t, std::uintptr_t) noexcept {
+      }
+      static void destruct (std::uintptr_t&, std::uintptr_t) noexcept {
+      }
+      static bool compare (std::uintptr_t const& lhs, std::uintptr_t const& rhs
+                         , std::uintptr_t mask) {
+        return ref (lhs, mask) == ref (rhs, mask);
+      }
+      static std::size_t hash (std::uintptr_t const& w, std::uintptr_t mask) {
+        return case_hash (ref (w, mask));
+      }
+      static T* ptr (std::uintptr_t& w, std::uintptr_t) {
+        return reinterpret_cast<T*>(&w);
+      }
+      static T& ref (std::uintptr_t& w, std::uintptr_t) {
+        return *reinterpret_cast<T*>(&w);
+      }
+      static T const& ref (std::uintptr_t const& w, std::uintptr_t) {
+        return *reinterpret_cast<T const*>(&w);
+      }
+    };
+
+    //This specialization handles boxed cases. Ownership of the value
+    //is passed to and from `recursive_wrapper<>` so the allocation
+    //policy is that of the wrapper
+    template <class T, class A>
+    struct tagged_pointer_case<recursive_wrapper<T, A>> {
+      template <class... Args>
+      static std::uintptr_t make (
+        std::uintptr_t&, std::size_t i, Args&&... args) {
+        recursive_wrapper<T, A> w (std::forward<Args>(args)...);
+        std::uintptr_t const p = reinterpret_cast<std::uintptr_t>(w.release ());
+        assert (p % alignof (std::max_align_t) == 0);
+        return p | i;
+      }
+      static void copy (std::uintptr_t& w, std::uintptr_t const& src
+                      , std::size_t i, std::uintptr_t mask) {
+        w = make (w, i, ref (src, mask));
+      }
+      static void assign (std::uintptr_t& w, std::uintptr_t const& src
+                        , std::size_t i, std::uintptr_t mask) {
+        recursive_wrapper<T, A> owner (adopt_t{}, pointer (w, mask));
+        PGS_TRY {
+          owner = ref (src, mask);
+        }
+        PGS_CATCH_ALL {
+          owner.release ();
+          PGS_RETHROW
+        }
+        w = reinterpret_cast<std::uintptr_t>(owner.release ()) | i;
+      }
+      static void destruct (std::uintptr_t& w, std::uintptr_t mask) {
+        recursive_wrapper<T, A> owner (adopt_t{}, pointer (w, mask));
+      }
+      static bool compare (std::uintptr_t const& lhs, std::uintptr_t const& rhs
+                         , std::uintptr_t mask) {
+        return boxed_equal (ref (lhs, mask), ref (rhs, mask));
+      }
+      static std::size_t hash (std::uintptr_t const& w, std::uintptr_t mask) {
+        return std::hash<T>{}(ref (w, mask));
+      }
+      static T* pointer (std::uintptr_t w, std::uintptr_t mask) {
+        return reinterpret_cast<T*>(w & ~mask);
+      }
+      static T* ptr (std::uintptr_t& w, std::uintptr_t mask) {
+        return pointer (w, mask);
+      }
+      static T& ref (std::uintptr_t& w, std::uintptr_t mask) {
+        return *pointer (w, mask);
+      }
+      static T const& ref (std::uintptr_t const& w, std::uintptr_t mask) {
+        return *pointer (w, mask);
+      }
+    };
+
+    //This specialization handles shared boxed cases : the word holds
+    //the address of the node and copies share it
+    template <class T, class C>
+    struct tagged_pointer_case<shared_recursive_wrapper<T, C>> {
+      using wrapper_type = shared_recursive_wrapper<T, C>;
+      using node_type = typename wrapper_type::node_type;
+
+      template <class... Args>
+      static std::uintptr_t make (
+        std::uintptr_t&, std::size_t i, Args&&... args) {
+        wrapper_type w (std::forward<Args>(args)...);
+        std::uintptr_t const p = reinterpret_cast<std::uintptr_t>(w.release ());
+        assert (p % alignof (std::max_align_t) == 0);
+        return p | i;
+      }
+      static void copy (std::uintptr_t& w, std::uintptr_t const& src
+                      , std::size_t i, std::uintptr_t mask) {
+        wrapper_type owner (adopt_t{}, node (src, mask));
+        wrapper_type shared (static_cast<wrapper_type const&>(owner));
+        owner.release ();
+        w = reinterpret_cast<std::uintptr_t>(shared.release ()) | i;
+      }
+      static void assign (std::uintptr_t& w, std::uintptr_t const& src
+                        , std::size_t i, std::uintptr_t mask) {
+        std::uintptr_t old = w;
+        copy (w, src, i, mask);
+        destruct (old, mask);
+      }
+      static void destruct (std::uintptr_t& w, std::uintptr_t mask) {
+        wrapper_type owner (adopt_t{}, node (w, mask));
+      }
+      static bool compare (std::uintptr_t const& lhs, std::uintptr_t const& rhs
+                         , std::uintptr_t mask) {
+        return shared_equal (node (lhs, mask), node (rhs, mask));
+      }
+      static std::size_t hash (std::uintptr_t const& w, std::uintptr_t mask) {
+        return node_hash (*node (w, mask));
+      }
+      static node_type* node (std::uintptr_t w, std::uintptr_t mask) {
+        return reinterpret_cast<node_type*>(w & ~mask);
+      }
+      static T* ptr (std::uintptr_t& w, std::uintptr_t mask) {
+        return &node (w, mask)->value;
+      }
+      static T& ref (std::uintptr_t& w, std::uintptr_t mask) {
+        return node (w, mask)->value;
+      }
+      static T const& ref (std::uintptr_t const& w, std::uintptr_t mask) {
+        return node (w, mask)->value;
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief Metafunction to determine if the cases `Ts...` can be
+  //! represented by a `tagged_pointer_union<>`
+  //!
+  //! That is the case when every one of `Ts...` is either a
+  //! `recursive_wrapper<>` with a stateless allocator known to align
+  //! as `operator new` does (see `is_max_aligned_allocator<>`), a
+  //! `shared_recursive_wrapper<>` or an empty, trivially destructible
+  //! type, at least one of them is a wrapper and the number of
+  //! cases is no more than the guaranteed alignment of a heap
+  //! allocation.
+  template <class... Ts>
+  struct is_tagged_pointer_representable
+    : and_<
+          std::integral_constant<bool,
+            sizeof... (Ts) <= alignof (std::max_align_t)>
+        , or_<is_recursive_wrapper<Ts>...>
+        , detail::is_tagged_pointer_case<Ts>...>
+  {};
+
+  //! \class tagged_pointer_union
+  //!
+  //! \brief A storage type for the sum type that is a single pointer
+  //!
+  //! The value of a boxed case is held on the heap and the word holds
+  //! its address. A case carrying no data is represented by a null
+  //! address. In both cases, the active index is held in the low bits
+  //! of the word (the storage records the active index itself).
+  //!
+  //! A `tagged_pointer_union<>` that has been moved from holds the
+  //! index of the case it held and, if that case was boxed, a null
+  //! address. It may be destroyed or assigned to.
+  //!
+  //! `tagged_pointer_union<>` provides the same interface as
+  //! `recursive_union<>` and is selected by `sum_type_storage<>` when
+  //! `is_tagged_pointer_representable<Ts...>`.
+  //!
+  //! \tparam Ts The cases of the union
+  template <class... Ts>
+  struct tagged_pointer_union {
+  private:
+    std::uintptr_t word;
+
+    static constexpr std::size_t bits =
+      detail::tagged_pointer_bits (sizeof... (Ts));
+
+    template <class U>
+    using index_of_case = index_of<U, Ts...>;
+
+  public:
+
+    //! \brief The mask selecting the bits of the word that hold the
+    //! active index
+    static constexpr std::uintptr_t mask = (std::uintptr_t{1} << bits) - 1;
+
+    //! \brief The type (as stored, that is before unwrapping any
+    //! `recursive_wrapper<>`) at index `I` of `Ts...`
+    template <std::size_t I>
+    using type_at_storage =
+      typename std::tuple_element<I, std::tuple<Ts...>>::type;
+
+    //! \brief Default ctor
+    tagged_pointer_union ()
+    {}
+
+    //! \brief Construct the case of `Ts...` that is `U` or is a
+    //! `recursive_wrapper<U>`
+    template <class U, class... Args>
+    explicit tagged_pointer_union (constructor<U>, Args&&... args) {
+      using T = type_at_storage<index_of_case<U>::value>;
+      word = detail::tagged_pointer_case<T>::make (
+        word, index_of_case<U>::value, std::forward<Args>(args)...);
+    }
+
+    //! \brief The active index
+    std::size_t index () const noexcept {
+      return word & mask;
+    }
+
+    //! \brief Copy
+    //!
+    //! Copy the value of `u` at index `i`
+    void copy (std::size_t i, tagged_pointer_union const& u) {
+      using entry_type = void (*)(
+        std::uintptr_t&, std::uintptr_t const&, std::size_t, std::uintptr_t);
+      static constexpr entry_type table[] = {
+        &detail::tagged_pointer_case<Ts>::copy...
+      };
+      table[i] (word, u.word, i, mask);
+    }
+
+    //! \brief Move
+    //!
+    //! Take the value of `u` at index `i` (`u` no longer owns a
+    //! boxed value)
+    void move (std::size_t i, tagged_pointer_union&& u) noexcept {
+      word = u.word;
+      u.word = i;
+    }
+
+    //! \brief Copy-assign
+    //!
+    //! Copy-assign the value of `u` at index `i` to the (active)
+    //! value at index `i` (a boxed value is assigned in its node, a
+    //! shared node is shared)
+    void assign (std::size_t i, tagged_pointer_union const& u) {
+      using entry_type = void (*)(
+        std::uintptr_t&, std::uintptr_t const&, std::size_t, std::uintptr_t);
+      static constexpr entry_type table[] = {
+        &detail::tagged_pointer_case<Ts>::assign...
+      };
+      table[i] (word, u.word, i, mask);
+    }
+
+    //! \brief Move-assign
+    //!
+    //! Release the value at index `i` and take that of `u` (taking
+    //! the node of `u` is cheaper than assigning into ours)
+    void move_assign (std::size_t i, tagged_pointer_union&& u) noexcept {
+      destruct (i);
+      move (i, std::move (u));
+    }
+
+    //! \brief Destruct
+    //!
+    //! Destroy the value at index `i`
+    void destruct (std::size_t i) noexcept {
+      using entry_type = void (*)(std::uintptr_t&, std::uintptr_t);
+      static constexpr entry_type table[] = {
+        &detail::tagged_pointer_case<Ts>::destruct...
+      };
+      table[i] (word, mask);
+    }
+
+    //! \brief Equality comparison
+    //!
+    //! Compare the values at index `i` of self and `rhs`
+    bool compare (std::size_t i, tagged_pointer_union const& rhs)
+      const noexcept {
+      using entry_type =
+        bool (*)(std::uintptr_t const&, std::uintptr_t const&, std::uintptr_t);
+      static constexpr entry_type table[] = {
+        &detail::tagged_pointer_case<Ts>::compare...
+      };
+      return table[i] (word, rhs.word, mask);
+    }
+
+    //! \brief Hash
+    //!
+    //! Hash the value at index `i`
+    std::size_t hash (std::size_t i) const {
+      using entry_type = std::size_t (*)(std::uintptr_t const&, std::uintptr_t);
+      static constexpr entry_type table[] = {
+        &detail::tagged_pointer_case<Ts>::hash...
+      };
+      return table[i] (word, mask);
+    }
+
+    //! \brief Produce a pointer to the `I`th value (`nullptr` if that
+    //! is a `recursive_wrapper<>` that has been moved from)
+    template <std::size_t I>
+    auto ptr () -> decltype (detail::tagged_pointer_case<
+        type_at_storage<I>>::ptr (std::declval<std::uintptr_t&>(), 0)) {
+      return detail::tagged_pointer_case<type_at_storage<I>>::ptr (word, mask);
+    }
+
+    //! \brief Produce a reference to the `I`th value
+    template <std::size_t I>
+    auto ref () -> decltype (detail::tagged_pointer_case<
+        type_at_storage<I>>::ref (std::declval<std::uintptr_t&>(), 0)) {
+      return detail::tagged_pointer_case<type_at_storage<I>>::ref (word, mask);
+    }
+
+    //! \brief Produce a `const` reference to the `I`th value
+    template <std::size_t I>
+    auto ref () const -> decltype (detail::tagged_pointer_case<
+        type_at_storage<I>>::ref (std::declval<std::uintptr_t const&>(), 0)) {
+      return detail::tagged_pointer_case<type_at_storage<I>>::ref (word, mask);
+    }
+  };
+
+  //! \brief Produce a non-`const` reference to the `I`th value of a
+  //! `tagged_pointer_union<>` (the object referred to if that value is
+  //! a `recursive_wrapper<>`)
+  template <std::size_t I, class... Ts>
+  auto union_ref (tagged_pointer_union<Ts...>& u)
+    -> decltype (u.template ref<I> ()) {
+    return u.template ref<I> ();
+  }
+
+  //! \brief Produce a `const` reference to the `I`th value of a
+  //! `tagged_pointer_union<>` (the object referred to if that value is
+  //! a `recursive_wrapper<>`)
+  template <std::size_t I, class... Ts>
+  auto union_ref (tagged_pointer_union<Ts...> const& u)
+    -> decltype (u.template ref<I> ()) {
+    return u.template ref<I> ();
+  }
+
+  //! \brief Produce a pointer to the `I`th value of a
+  //! `tagged_pointer_union<>` (the object referred to if that value is
+  //! a `recursive_wrapper<>`, `nullptr` if that wrapper has been moved
+  //! from)
+  template <std::size_t I, class... Ts>
+  auto union_ptr (tagged_pointer_union<Ts...>& u)
+    -> decltype (u.template ptr<I> ()) {
+    return u.template ptr<I> ();
+  }
+
+}//namespace pgs
+
+#endif //!defined (TAGGED_POINTER_UNION_0C3D7E9A_61F2_4E4B_8D0B_7A2E5C94F1D3_H)
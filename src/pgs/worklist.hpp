@@ -0,0 +1,483 @@
+#if !defined (WORKLIST_6C0E4B97_1F3D_4A82_B7E5_93D2A8C05F16_H)
+#  define WORKLIST_6C0E4B97_1F3D_4A82_B7E5_93D2A8C05F16_H
+
+//! \file worklist.hpp
+//!
+//! \brief Constant stack depth traversal of recursive values
+//!
+//! Destroying a recursive value by way of the destructors of its
+//! parts recurses once per node : a long enough list or a deep enough
+//! tree overflows the stack. Instead, the destruction of a node
+//! reached (on the same thread) more than a fixed number of levels
+//! below the one being destroyed is deferred to a worklist that is
+//! drained by the outermost destruction. The stack depth is bounded
+//! by that of destroying that many nested nodes.
+//!
+//! Copying and comparing recursive values recurse in the same way,
+//! and by default they keep doing so : copying a deep enough value,
+//! or applying `==` or `<` to one, overflows the stack. Types may opt
+//! in to having them worked in the same fashion as destruction (see
+//! `iterative_copy<>`, `iterative_equality<>` and
+//! `iterative_ordering<>`).
+
+#  include <pgs/config.hpp>
+
+#  include <cassert>
+#  include <cstddef>
+#  include <cstdio>
+#  include <cstdlib>
+#  include <cstring>
+#  include <type_traits>
+#  include <vector>
+
+namespace pgs {
+
+  //! \cond
+  namespace detail {
+
+    //The nodes awaiting destruction on this thread. Nodes nested up
+    //to `max_depth` deep in the one being destroyed are destroyed
+    //recursively (values that don't nest deeply never pay for the
+    //worklist), deeper ones are deferred along with a copy of the
+    //state needed to destroy them (the allocator of the node)
+    class destruction_worklist {
+    public:
+      using destroy_type = void (*)(void*, void const*);
+
+      //The number of nested destructions run recursively
+      static constexpr std::size_t max_depth = 64;
+
+      //The room for the state of a deferred destruction
+      static constexpr std::size_t state_size = 2 * sizeof (void*);
+
+      //`true` if a `S` can be kept as the state of a deferred
+      //destruction (it is copied bytewise)
+      template <class S>
+      struct is_state
+        : std::integral_constant<bool,
+            std::is_trivially_copyable<S>::value
+            && sizeof (S) <= state_size && alignof (S) <= alignof (void*)>
+      {};
+
+    private:
+      struct entry {
+        void* p;
+        destroy_type destroy;
+        typename std::aligned_storage<state_size, alignof (void*)>::type state;
+      };
+
+      std::vector<entry> work_;
+
+      destruction_worklist () noexcept
+      {}
+
+      static destruction_worklist& instance () {
+        static thread_local destruction_worklist worklist;
+        return worklist;
+      }
+
+      //The depth of the destruction in progress (`0` if none). Kept
+      //out of the worklist for it is constant initialized (no guard
+      //to test on access)
+      static std::size_t& depth () noexcept {
+        static thread_local std::size_t depth = 0;
+        return depth;
+      }
+
+    public:
+      //Destroy `p` by `f (p, s)`, now if no destruction is in progress
+      //(and then everything deferred by it) or if it is not yet
+      //`max_depth` deep or else, later (`f` is then passed a copy of
+      //the `size` bytes at `s`)
+      static void destroy (void* p, destroy_type f
+                         , void const* s = nullptr, std::size_t size = 0
+      ) noexcept {
+        assert (size <= state_size);
+        std::size_t& d = depth ();
+        if (d != 0) {
+          if (d < max_depth) {
+            ++d;
+            f (p, s);
+            --d;
+            return;
+          }
+          PGS_TRY {
+            entry e;
+            e.p = p;
+            e.destroy = f;
+            if (size != 0)
+              std::memcpy (&e.state, s, size);
+            instance ().work_.push_back (e);
+            return;
+          }
+          PGS_CATCH_ALL {
+            //Out of memory : fall back on recursion
+          }
+          f (p, s);
+          return;
+        }
+        d = 1;
+        f (p, s);
+        std::vector<entry>& work = instance ().work_;
+        while (!work.empty ()) {
+          entry const e = work.back ();
+          work.pop_back ();
+          e.destroy (e.p, &e.state);
+        }
+        d = 0;
+      }
+    };
+
+    //The nodes awaiting construction (as copies) on this thread. The
+    //storage of a node is allocated (and owned by its wrapper) at
+    //once, its construction is deferred
+    class copy_worklist {
+    public:
+      using construct_type = void (*)(void*, void const*);
+      using free_type = void (*)(void*);
+
+    private:
+      struct entry {
+        void* dst;
+        void const* src;
+        construct_type construct;
+        free_type deallocate;
+      };
+
+      std::vector<entry> work_;
+      entry current_;
+      bool active_;
+
+      copy_worklist () noexcept
+        : current_ {nullptr, nullptr, nullptr, nullptr}, active_ {false}
+      {}
+
+    public:
+      static copy_worklist& instance () {
+        static thread_local copy_worklist worklist;
+        return worklist;
+      }
+
+      //Construct (by `construct (dst, src)`) the storage `dst`, now
+      //if no copy is in progress (and then everything deferred by it)
+      //or else, later. On an exception, `dst` is left unconstructed
+      //(the nodes constructed meanwhile are destroyed by `destruct`,
+      //the storage of the nodes not yet constructed freed by
+      //`deallocate`)
+      void copy (void* dst, void const* src
+               , construct_type construct, free_type destruct
+               , free_type deallocate) {
+        if (active_) {
+          work_.push_back (entry {dst, src, construct, deallocate});
+          return;
+        }
+        active_ = true;
+        bool constructed = false;
+        PGS_TRY {
+          construct (dst, src);
+          constructed = true;
+          while (!work_.empty ()) {
+            current_ = work_.back ();
+            work_.pop_back ();
+            current_.construct (current_.dst, current_.src);
+            current_.dst = nullptr;
+          }
+        }
+        PGS_CATCH_ALL {
+          //Destroying what has been constructed cancels the nodes it
+          //owns that are pending
+          if (constructed)
+            destruct (dst);
+          if (current_.dst != nullptr)
+            current_.deallocate (current_.dst);
+          for (entry const& e : work_)
+            e.deallocate (e.dst);
+          work_.clear ();
+          current_.dst = nullptr;
+          active_ = false;
+          PGS_RETHROW
+        }
+        active_ = false;
+      }
+
+      //`true` if a copy is in progress
+      bool active () const noexcept {
+        return active_;
+      }
+
+      //If the storage `dst` is awaiting construction, forget it and
+      //return `true`
+      bool cancel (void* dst) noexcept {
+        if (current_.dst == dst) {
+          current_.dst = nullptr;
+          return true;
+        }
+        for (std::size_t i = work_.size (); i-- > 0;) {
+          if (work_[i].dst == dst) {
+            work_.erase (work_.begin () + i);
+            return true;
+          }
+        }
+        return false;
+      }
+    };
+
+    //The pairs of nodes awaiting comparison on this thread. The
+    //result of a comparison made while another is in progress is
+    //taken to be `true` and the comparison deferred, the outermost
+    //comparison is the conjunction of all of them
+    class equality_worklist {
+    public:
+      using compare_type = bool (*)(void const*, void const*);
+
+    private:
+      struct entry {
+        void const* lhs;
+        void const* rhs;
+        compare_type compare;
+      };
+
+      std::vector<entry> work_;
+      bool active_;
+
+      equality_worklist () noexcept : active_ {false}
+      {}
+
+    public:
+      static equality_worklist& instance () {
+        static thread_local equality_worklist worklist;
+        return worklist;
+      }
+
+      bool compare (void const* lhs, void const* rhs, compare_type f) {
+        if (active_) {
+          work_.push_back (entry {lhs, rhs, f});
+          return true;
+        }
+        active_ = true;
+        bool equal;
+        PGS_TRY {
+          equal = f (lhs, rhs);
+          while (equal && !work_.empty ()) {
+            entry const e = work_.back ();
+            work_.pop_back ();
+            equal = e.compare (e.lhs, e.rhs);
+          }
+        }
+        PGS_CATCH_ALL {
+          work_.clear ();
+          active_ = false;
+          PGS_RETHROW
+        }
+        work_.clear ();
+        active_ = false;
+        return equal;
+      }
+    };
+
+    //The pair of nodes whose ordering decides that of the pair being
+    //ordered on this thread. The result of an ordering of a type made
+    //while one of the same type is in progress is taken to be `false`
+    //and the ordering deferred : it is the result of the outermost
+    //ordering of that type. An ordering of another type (the head of
+    //a list of lists) is made in full, in a frame of its own
+    class ordering_worklist {
+    public:
+      using less_type = bool (*)(void const*, void const*);
+
+    private:
+      struct entry {
+        void const* lhs;
+        void const* rhs;
+        less_type less;
+      };
+
+      entry pending_;
+      less_type current_;
+
+      ordering_worklist () noexcept
+        : pending_ {nullptr, nullptr, nullptr}, current_ {nullptr}
+      {}
+
+      [[noreturn]] PGS_COLD static void contract_violated () {
+        std::fprintf (stderr, "pgs: a type opting in to "
+          "iterative_ordering<> ordered more than one nested value\n");
+        std::abort ();
+      }
+
+    public:
+      static ordering_worklist& instance () {
+        static thread_local ordering_worklist worklist;
+        return worklist;
+      }
+
+      bool less (void const* lhs, void const* rhs, less_type f) {
+        if (current_ == f) {
+          //At most one ordering of the type is deferred per node (the
+          //last one it makes, see `iterative_ordering<>`). A second
+          //would go unmade and the result be wrong : checked in every
+          //build
+          if (pending_.less != nullptr)
+            contract_violated ();
+          pending_ = entry {lhs, rhs, f};
+          return false;
+        }
+        //The frame of the ordering of the enclosing type (if any)
+        entry const pending = pending_;
+        less_type const current = current_;
+        pending_.less = nullptr;
+        current_ = f;
+        bool result;
+        PGS_TRY {
+          result = f (lhs, rhs);
+          while (pending_.less != nullptr) {
+            entry const e = pending_;
+            pending_.less = nullptr;
+            result = e.less (e.lhs, e.rhs);
+          }
+        }
+        PGS_CATCH_ALL {
+          pending_ = pending;
+          current_ = current;
+          PGS_RETHROW
+        }
+        pending_ = pending;
+        current_ = current;
+        return result;
+      }
+    };
+
+  }//namespace detail
+  //! \endcond
+
+  //! \brief A metafunction to determine if the recursive wrappers of
+  //! `T` (`recursive_wrapper<T, A>` for an `A` that is stateless or
+  //! trivially copyable and no bigger than two pointers, as is
+  //! `arena_allocator<>`, and `shared_recursive_wrapper<T, C>`) are
+  //! destroyed with constant stack depth
+  //!
+  //! The default is that they are. Specialize this template (to
+  //! derive from `std::false_type`) to have values of type `T`
+  //! destroyed as soon as their wrapper is (that is, recursively).
+  //! Values nested no more than a few dozen levels deep are destroyed
+  //! recursively either way, so this only saves the bookkeeping of
+  //! the depth.
+  //!
+  //! \tparam T The type of value
+  template <class T>
+  struct iterative_destruction : std::true_type
+  {};
+
+  //! \brief A metafunction to determine if the `recursive_wrapper<T,
+  //! A>`s (for a stateless `A`) nested in a value being copied are
+  //! copied with constant stack depth
+  //!
+  //! The default is that they are not (the stack depth of a copy is
+  //! that of the value). Specialize this template (to derive from
+  //! `std::true_type`) to opt in. The copy of a nested
+  //! value is then constructed after the copy of the value containing
+  //! it. So the copy constructor of `T` must not inspect the values
+  //! of the recursive wrappers it has copied.
+  //!
+  //! \tparam T The type of value
+  template <class T>
+  struct iterative_copy : std::false_type
+  {};
+
+  //! \brief A metafunction to determine if the recursive wrappers of
+  //! `T` nested in values being compared are compared with constant
+  //! stack depth
+  //!
+  //! The default is that they are not (the stack depth of a
+  //! comparison is that of the values). Specialize this template (to
+  //! derive from `std::true_type`) to opt in. The comparison of nested
+  //! values is then deferred (and their result taken to be `true` in
+  //! the meantime). So `operator==` for `T` must be the conjunction of
+  //! comparisons of its parts (as is the case for structural
+  //! equality).
+  //!
+  //! \tparam T The type of value
+  template <class T>
+  struct iterative_equality : std::false_type
+  {};
+
+  //! \brief A metafunction to determine if the recursive wrappers of
+  //! `T` nested in values being ordered (by `operator<`) are ordered
+  //! with constant stack depth
+  //!
+  //! The default is that they are not. Specialize this template (to
+  //! derive from `std::true_type`) to opt in. The ordering of a nested
+  //! value is then deferred (and its result taken to be `false` in the
+  //! meantime) and decides the ordering of the value containing it.
+  //! So `operator<` for `T` must order at most one nested value of
+  //! type `T`, last, and return that result (as a lexicographic
+  //! ordering of a list cell does : `x.hd < y.hd || (!(y.hd < x.hd) &&
+  //! x.tl < y.tl)`). Values of other types it orders (the heads of a
+  //! list of lists) are ordered in full beforehand, whether or not they
+  //! opt in too. Types nesting more than one value of type `T` (the
+  //! nodes of trees) do not qualify and are ordered recursively (the
+  //! stack depth is that of the trees) : a type that opts in and
+  //! orders a second nested value aborts the program.
+  //!
+  //! \tparam T The type of value
+  template <class T>
+  struct iterative_ordering : std::false_type
+  {};
+
+  //! \cond
+  namespace detail {
+
+    template <class T>
+    bool boxed_compare (void const* lhs, void const* rhs) {
+      return *static_cast<T const*>(lhs) == *static_cast<T const*>(rhs);
+    }
+
+    template <class T>
+    bool boxed_equal (T const& lhs, T const& rhs, std::false_type) {
+      return lhs == rhs;
+    }
+
+    template <class T>
+    bool boxed_equal (T const& lhs, T const& rhs, std::true_type) {
+      return equality_worklist::instance ().compare (
+        &lhs, &rhs, &boxed_compare<T>);
+    }
+
+    //Compare values held by recursive wrappers (values at the same
+    //address are equal)
+    template <class T>
+    bool boxed_equal (T const& lhs, T const& rhs) {
+      return &lhs == &rhs
+        || boxed_equal (lhs, rhs, iterative_equality<T>{});
+    }
+
+    template <class T>
+    bool boxed_order (void const* lhs, void const* rhs) {
+      return *static_cast<T const*>(lhs) < *static_cast<T const*>(rhs);
+    }
+
+    template <class T>
+    bool boxed_less (T const& lhs, T const& rhs, std::false_type) {
+      return lhs < rhs;
+    }
+
+    template <class T>
+    bool boxed_less (T const& lhs, T const& rhs, std::true_type) {
+      return ordering_worklist::instance ().less (
+        &lhs, &rhs, &boxed_order<T>);
+    }
+
+    //Order values held by recursive wrappers (a value at the same
+    //address is not less)
+    template <class T>
+    bool boxed_less (T const& lhs, T const& rhs) {
+      return &lhs != &rhs
+        && boxed_less (lhs, rhs, iterative_ordering<T>{});
+    }
+
+  }//namespace detail
+  //! \endcond
+
+}//namespace pgs
+
+#endif //!defined (WORKLIST_6C0E4B97_1F3D_4A82_B7E5_93D2A8C05F16_H)
@@ -0,0 +1,224 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //Counts the allocations made through it
+  struct resource {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+  };
+
+  //A stateful allocator (it refers to a `resource`)
+  template <class T>
+  struct counting_allocator {
+    using value_type = T;
+
+    resource* r;
+
+    explicit counting_allocator (resource* r) : r {r}
+    {}
+    template <class U>
+    counting_allocator (counting_allocator<U> const& a) : r {a.r}
+    {}
+
+    T* allocate (std::size_t n) {
+      ++r->allocations;
+      return static_cast<T*>(::operator new (n * sizeof (T)));
+    }
+    void deallocate (T* p, std::size_t) {
+      ++r->deallocations;
+      ::operator delete (p);
+    }
+  };
+
+  template <class T, class U>
+  bool operator== (counting_allocator<T> const& l, counting_allocator<U> const& r) {
+    return l.r == r.r;
+  }
+  template <class T, class U>
+  bool operator!= (counting_allocator<T> const& l, counting_allocator<U> const& r) {
+    return l.r != r.r;
+  }
+
+  //A stateless allocator (it refers to a global `resource`)
+  resource global;
+
+  template <class T>
+  struct global_allocator {
+    using value_type = T;
+
+    global_allocator ()
+    {}
+    template <class U>
+    global_allocator (global_allocator<U> const&)
+    {}
+
+    T* allocate (std::size_t n) {
+      return counting_allocator<T>{&global}.allocate (n);
+    }
+    void deallocate (T* p, std::size_t n) {
+      counting_allocator<T>{&global}.deallocate (p, n);
+    }
+  };
+
+  template <class T, class U>
+  bool operator== (global_allocator<T> const&, global_allocator<U> const&) {
+    return true;
+  }
+  template <class T, class U>
+  bool operator!= (global_allocator<T> const&, global_allocator<U> const&) {
+    return false;
+  }
+
+  //A stateless allocator that doesn't say how it aligns
+  template <class T>
+  struct unaligned_allocator : global_allocator<T> {
+    unaligned_allocator ()
+    {}
+    template <class U>
+    unaligned_allocator (unaligned_allocator<U> const&)
+    {}
+  };
+
+  //An empty allocator that can't be made at will (it isn't
+  //stateless : the one a node was allocated by is kept)
+  template <class T>
+  struct explicit_allocator : global_allocator<T> {
+    explicit explicit_allocator (int)
+    {}
+    template <class U>
+    explicit_allocator (explicit_allocator<U> const&)
+    {}
+  };
+
+  template <template <class> class A> struct cons_t;
+  struct nil_t {};
+  bool operator== (nil_t const&, nil_t const&) { return true; }
+
+  template <template <class> class A>
+  using list = sum_type<recursive_wrapper<cons_t<A>, A<cons_t<A>>>, nil_t>;
+
+  template <template <class> class A>
+  struct cons_t {
+    int hd;
+    list<A> tl;
+
+    template <class L>
+    cons_t (int hd, L&& tl) : hd {hd}, tl (std::forward<L>(tl))
+    {}
+  };
+
+  template <template <class> class A>
+  bool operator== (cons_t<A> const& l, cons_t<A> const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  template <template <class> class A>
+  list<A> cons (A<cons_t<A>> const& a, int hd, list<A> tl) {
+    return list<A>{
+      constructor<cons_t<A>>{}, std::allocator_arg, a, hd, std::move (tl)};
+  }
+
+  template <template <class> class A>
+  int sum (list<A> const& l) {
+    return l.template match<int>(
+      [](cons_t<A> const& c) { return c.hd + sum (c.tl); },
+      [](nil_t const&) { return 0; });
+  }
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  //`global_allocator<>` obtains its storage from `operator new`
+  template <class T>
+  struct is_max_aligned_allocator<global_allocator<T>> : std::true_type
+  {};
+
+}//namespace pgs
+
+TEST (pgs, allocator) {
+
+  resource r;
+  {
+    counting_allocator<cons_t<counting_allocator>> a{&r};
+    list<counting_allocator> nil{constructor<nil_t>{}};
+    list<counting_allocator> l = cons (a, 1, cons (a, 2, cons (a, 3, nil)));
+    ASSERT_EQ (sum (l), 6);
+    ASSERT_EQ (r.allocations, 3u);
+
+    //Copies allocate from the allocator of the original
+    list<counting_allocator> m = l;
+    ASSERT_EQ (m, l);
+    ASSERT_EQ (r.allocations, 6u);
+
+    //Moves don't allocate
+    list<counting_allocator> n = std::move (m);
+    ASSERT_EQ (r.allocations, 6u);
+    ASSERT_EQ (n, l);
+  }
+  ASSERT_EQ (r.deallocations, 6u);
+}
+
+TEST (pgs, allocator_stateless) {
+
+  //A stateless allocator doesn't prevent the tagged representation
+  static_assert (sizeof (list<global_allocator>) == sizeof (void*), "");
+  //A stateful one does
+  static_assert (
+    !sum_type_layout<
+      recursive_wrapper<
+        cons_t<counting_allocator>
+      , counting_allocator<cons_t<counting_allocator>>>
+    , nil_t>::index_in_storage, "");
+  //So does one that isn't known to align as `operator new` does (the
+  //low bits of the addresses it returns may be in use)
+  static_assert (
+    !sum_type_layout<
+      recursive_wrapper<
+        cons_t<unaligned_allocator>
+      , unaligned_allocator<cons_t<unaligned_allocator>>>
+    , nil_t>::index_in_storage, "");
+
+  {
+    global_allocator<cons_t<global_allocator>> a;
+    list<global_allocator> nil{constructor<nil_t>{}};
+    list<global_allocator> l = cons (a, 1, cons (a, 2, nil));
+    list<global_allocator> m = l;
+    ASSERT_EQ (sum (m), 3);
+    ASSERT_EQ (global.allocations, 4u);
+  }
+  ASSERT_EQ (global.deallocations, 4u);
+}
+
+TEST (pgs, allocator_not_stateless) {
+
+  //Being empty doesn't make an allocator stateless
+  static_assert (
+    !sum_type_layout<
+      recursive_wrapper<
+        cons_t<explicit_allocator>
+      , explicit_allocator<cons_t<explicit_allocator>>>
+    , nil_t>::index_in_storage, "");
+
+  std::size_t const allocations = global.allocations;
+  std::size_t const deallocations = global.deallocations;
+  {
+    explicit_allocator<cons_t<explicit_allocator>> a{0};
+    list<explicit_allocator> nil{constructor<nil_t>{}};
+    list<explicit_allocator> l = cons (a, 1, cons (a, 2, nil));
+    list<explicit_allocator> m = l;
+    ASSERT_EQ (sum (m), 3);
+    ASSERT_EQ (global.allocations - allocations, 4u);
+  }
+  ASSERT_EQ (global.deallocations - deallocations, 4u);
+}
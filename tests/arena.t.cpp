@@ -0,0 +1,153 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //An expression type whose nodes live in an arena
+  template <class T>
+  using boxed = recursive_wrapper<T, arena_allocator<T>>;
+
+  struct lit_t {
+    int value;
+  };
+  bool operator== (lit_t const& l, lit_t const& r) {
+    return l.value == r.value;
+  }
+
+  std::size_t destroyed = 0;
+
+  //Additions are skipped on destruction...
+  struct add_t;
+  //...multiplications are not
+  struct mul_t;
+
+  using xpr_t = sum_type<lit_t, boxed<add_t>, boxed<mul_t>>;
+
+  struct add_t {
+    xpr_t l, r;
+    add_t (xpr_t l, xpr_t r) : l (std::move (l)), r (std::move (r))
+    {}
+    ~add_t () { ++destroyed; }
+  };
+  bool operator== (add_t const& l, add_t const& r) {
+    return l.l == r.l && l.r == r.r;
+  }
+
+  struct mul_t {
+    xpr_t l, r;
+    mul_t (xpr_t l, xpr_t r) : l (std::move (l)), r (std::move (r))
+    {}
+    ~mul_t () { ++destroyed; }
+  };
+  bool operator== (mul_t const& l, mul_t const& r) {
+    return l.l == r.l && l.r == r.r;
+  }
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct arena_skips_destruction<add_t> : std::true_type
+  {};
+
+}//namespace pgs
+
+namespace {
+
+  xpr_t lit (int i) {
+    return xpr_t{constructor<lit_t>{}, lit_t{i}};
+  }
+
+  xpr_t add (arena& a, xpr_t l, xpr_t r) {
+    return xpr_t{constructor<add_t>{}
+      , std::allocator_arg, arena_allocator<add_t>{a}, std::move (l), std::move (r)};
+  }
+
+  xpr_t mul (arena& a, xpr_t l, xpr_t r) {
+    return xpr_t{constructor<mul_t>{}
+      , std::allocator_arg, arena_allocator<mul_t>{a}, std::move (l), std::move (r)};
+  }
+
+  int eval (xpr_t const& x) {
+    return x.match<int>(
+      [](lit_t const& i) { return i.value; },
+      [](add_t const& e) { return eval (e.l) + eval (e.r); },
+      [](mul_t const& e) { return eval (e.l) * eval (e.r); });
+  }
+
+  //A list whose cells own memory outside the arena (they must be
+  //destroyed)
+  struct cell_t;
+  struct end_t {};
+
+  using strings = sum_type<boxed<cell_t>, end_t>;
+
+  struct cell_t {
+    std::string hd;
+    strings tl;
+    cell_t (std::string hd, strings tl)
+      : hd (std::move (hd)), tl (std::move (tl))
+    {}
+    ~cell_t () { ++destroyed; }
+  };
+
+}//namespace<anonymous>
+
+TEST (pgs, arena) {
+
+  arena a{256};
+
+  //Enough nodes to need several chunks
+  {
+    xpr_t x = lit (0);
+    for (int i = 1; i <= 1000; ++i)
+      x = add (a, std::move (x), lit (i));
+    ASSERT_EQ (eval (x), 500500);
+    destroyed = 0;
+  }
+  //Destruction stopped at the root
+  ASSERT_EQ (destroyed, 0u);
+
+  //Copies go to the same arena
+  {
+    xpr_t x = mul (a, lit (6), lit (7));
+    xpr_t y = x;
+    ASSERT_EQ (eval (y), 42);
+    ASSERT_EQ (x, y);
+    destroyed = 0;
+  }
+  //`mul_t` nodes are destroyed
+  ASSERT_EQ (destroyed, 2u);
+
+  a.release ();
+
+  //The arena can be reused after release
+  {
+    xpr_t x = add (a, lit (1), mul (a, lit (2), lit (3)));
+    ASSERT_EQ (eval (x), 7);
+  }
+}
+
+TEST (pgs, arena_deep) {
+
+  arena a;
+
+  //The allocator is kept with the nodes whose destruction is deferred
+  //so deep structures are destroyed with constant stack depth
+  {
+    strings l{constructor<end_t>{}};
+    for (int i = 0; i < 2000000; ++i)
+      l = strings{constructor<cell_t>{}, std::allocator_arg
+        , arena_allocator<cell_t>{a}, std::string (32, 'x'), std::move (l)};
+    destroyed = 0;
+  }
+  ASSERT_EQ (destroyed, 2000000u);
+}
@@ -128,7 +128,7 @@ namespace {
         persistent_array<T> res{
           new array_data<T>{constructor<array_t<T>>{}, std::move (a.data)}};
         //Now, replace the contents of `t` with an indirection
-        *(const_cast<persistent_array<T>&>(t)) = array_data<T>{constructor<diff_t<T>>{}, i, old, res};
+        t->template emplace<diff_t<T>> (i, old, res);
 
         return res;
       }
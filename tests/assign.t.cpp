@@ -0,0 +1,115 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  //A case counting how it is copied and moved
+  struct tally_t {
+    static int constructions;
+    static int assignments;
+
+    int i;
+    explicit tally_t (int i) : i {i}
+    {}
+    tally_t (tally_t const& t) : i {t.i} { ++constructions; }
+    tally_t (tally_t&& t) noexcept : i {t.i} { ++constructions; }
+    tally_t& operator= (tally_t const& t) {
+      i = t.i;
+      ++assignments;
+      return *this;
+    }
+    tally_t& operator= (tally_t&& t) noexcept {
+      i = t.i;
+      ++assignments;
+      return *this;
+    }
+  };
+  int tally_t::constructions = 0;
+  int tally_t::assignments = 0;
+
+  //A case that cannot be assigned
+  struct fixed_t {
+    int const i;
+    explicit fixed_t (int i) : i {i}
+    {}
+  };
+
+  using atom = sum_type<int, std::string, tally_t, fixed_t, nil_t>;
+  using boxed = sum_type<nil_t, recursive_wrapper<tally_t>>;
+  using shared = sum_type<nil_t, shared_recursive_wrapper<tally_t>>;
+
+  void reset () {
+    tally_t::constructions = tally_t::assignments = 0;
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, assign) {
+
+  //The active case is assigned...
+  atom a{constructor<tally_t>{}, 1};
+  atom b{constructor<tally_t>{}, 2};
+  reset ();
+  a = b;
+  ASSERT_EQ (get<tally_t> (a).i, 2);
+  ASSERT_EQ (tally_t::assignments, 1);
+  ASSERT_EQ (tally_t::constructions, 0);
+  a = atom{constructor<tally_t>{}, 3};
+  ASSERT_EQ (get<tally_t> (a).i, 3);
+  ASSERT_EQ (tally_t::assignments, 2);
+  ASSERT_EQ (tally_t::constructions, 0);
+
+  //...unless another case is assigned
+  a = atom{constructor<std::string>{}, "one"};
+  a = atom{constructor<tally_t>{}, 4};
+  ASSERT_EQ (get<tally_t> (a).i, 4);
+  ASSERT_EQ (tally_t::assignments, 2);
+  ASSERT_EQ (tally_t::constructions, 1);
+
+  //A case that cannot be assigned is constructed anew
+  atom f{constructor<fixed_t>{}, 1};
+  atom g{constructor<fixed_t>{}, 2};
+  f = g;
+  ASSERT_EQ (get<fixed_t> (f).i, 2);
+  f = atom{constructor<fixed_t>{}, 3};
+  ASSERT_EQ (get<fixed_t> (f).i, 3);
+}
+
+TEST (pgs, assign_boxed) {
+
+  //The node of a boxed case is reused
+  boxed a{constructor<tally_t>{}, 1};
+  boxed b{constructor<tally_t>{}, 2};
+  tally_t const* node = &get<tally_t> (a);
+  reset ();
+  a = b;
+  ASSERT_EQ (&get<tally_t> (a), node);
+  ASSERT_EQ (get<tally_t> (a).i, 2);
+  ASSERT_EQ (tally_t::assignments, 1);
+  ASSERT_EQ (tally_t::constructions, 0);
+
+  //Moving takes the node of the source
+  tally_t const* source = &get<tally_t> (b);
+  a = std::move (b);
+  ASSERT_EQ (&get<tally_t> (a), source);
+  ASSERT_EQ (tally_t::constructions, 0);
+
+  //Shared nodes are shared
+  shared x{constructor<tally_t>{}, 1};
+  shared y{constructor<tally_t>{}, 2};
+  x = y;
+  ASSERT_EQ (&get<tally_t> (x), &get<tally_t> (y));
+  x = x;
+  ASSERT_EQ (get<tally_t> (x).i, 2);
+  y = shared{constructor<tally_t>{}, 3};
+  ASSERT_EQ (get<tally_t> (x).i, 2);
+  ASSERT_EQ (get<tally_t> (y).i, 3);
+}
@@ -0,0 +1,68 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+namespace {
+
+  using namespace pgs;
+
+  //The instructions of a stack machine
+  struct push_t {
+    int value;
+    constexpr explicit push_t (int value) : value {value}
+    {}
+  };
+  struct add_t {};
+  struct jump_t {
+    std::size_t target;
+    constexpr explicit jump_t (std::size_t target) : target {target}
+    {}
+  };
+
+  using opcode = sum_type<push_t, add_t, jump_t>;
+
+  //A program built at compile time
+  constexpr opcode program[] = {
+      opcode{constructor<push_t>{}, 2}
+    , opcode{constructor<push_t>{}, 3}
+    , opcode{constructor<add_t>{}}
+    , opcode{constructor<jump_t>{}, 0}
+  };
+
+  //The change in the depth of the stack of an instruction
+  struct push_effect {
+    constexpr int operator () (push_t const&) const { return 1; }
+  };
+  struct add_effect {
+    constexpr int operator () (add_t const&) const { return -1; }
+  };
+  struct jump_effect {
+    constexpr int operator () (jump_t const&) const { return 0; }
+  };
+
+  constexpr int depth (std::size_t pc) {
+    return pc == sizeof (program) / sizeof (opcode)
+      ? 0
+      : program[pc].match<int>(push_effect{}, add_effect{}, jump_effect{})
+        + depth (pc + 1);
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, constexpr) {
+
+  static_assert (program[0].is<push_t>(), "");
+  static_assert (program[2].is<add_t>(), "");
+  static_assert (program[3].is_type_at<2>(), "");
+  static_assert (get<push_t>(program[1]).value == 3, "");
+  static_assert (get<2>(program[3]).target == 0, "");
+  static_assert (depth (0) == 1, "");
+
+  //The same at run time
+  std::size_t pc = 2;
+  ASSERT_EQ (program[pc].match<int>(
+    push_effect{}, add_effect{}, jump_effect{}), -1);
+  ASSERT_THROW (get<push_t>(program[pc]), invalid_sum_type_access);
+}
@@ -0,0 +1,150 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+  struct cons_t;
+  struct node_t;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <> struct iterative_copy<cons_t> : std::true_type {};
+  template <> struct iterative_equality<cons_t> : std::true_type {};
+  template <> struct iterative_copy<node_t> : std::true_type {};
+  template <> struct iterative_equality<node_t> : std::true_type {};
+
+}//namespace pgs
+
+namespace {
+
+  using namespace pgs;
+
+  //Lists (in the tagged pointer representation) and left combs (in
+  //the union representation) whose nodes count the live instances and
+  //whose payloads can be made to fail to copy
+  std::size_t live = 0;
+  int copies_left = -1;
+
+  struct payload {
+    int value;
+    explicit payload (int value) : value {value}
+    {}
+    payload (payload const& rhs) : value {rhs.value} {
+      if (copies_left == 0)
+        throw std::runtime_error ("payload");
+      if (copies_left > 0)
+        --copies_left;
+    }
+  };
+  bool operator== (payload const& l, payload const& r) {
+    return l.value == r.value;
+  }
+
+  struct nil_t {};
+  bool operator== (nil_t const&, nil_t const&) { return true; }
+
+  using list = sum_type<recursive_wrapper<cons_t>, nil_t>;
+  struct cons_t {
+    payload hd;
+    list tl;
+    cons_t (int hd, list tl) : hd {hd}, tl (std::move (tl)) { ++live; }
+    cons_t (cons_t const& rhs) : hd (rhs.hd), tl (rhs.tl) { ++live; }
+    ~cons_t () { --live; }
+  };
+  bool operator== (cons_t const& l, cons_t const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  using comb = sum_type<int, recursive_wrapper<node_t>>;
+  struct node_t {
+    comb left;
+    payload right;
+    node_t (comb left, int right) : left (std::move (left)), right {right}
+    { ++live; }
+    node_t (node_t const& rhs) : left (rhs.left), right (rhs.right)
+    { ++live; }
+    ~node_t () { --live; }
+  };
+  bool operator== (node_t const& l, node_t const& r) {
+    return l.left == r.left && l.right == r.right;
+  }
+
+  //[0, n) (but for the last element, `end`)
+  list iota (int n, int end) {
+    list l{constructor<nil_t>{}};
+    for (int i = 0; i < n; ++i)
+      l = list{constructor<cons_t>{}, i == 0 ? end : n - 1 - i, std::move (l)};
+    return l;
+  }
+
+  list iota (int n) {
+    return iota (n, n - 1);
+  }
+
+  comb spine (int n) {
+    comb c{constructor<int>{}, 0};
+    for (int i = 0; i < n; ++i)
+      c = comb{constructor<node_t>{}, std::move (c), i};
+    return c;
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, iterative_copy_and_equality) {
+
+  //Deep enough to overflow the stack if copy or comparison recursed
+  int const n = 1000000;
+
+  live = 0;
+  {
+    list l = iota (n);
+    list m = l;
+    ASSERT_EQ (live, 2u * n);
+    ASSERT_TRUE (l == m);
+    ASSERT_TRUE (l == l);
+    list o = iota (n, -1);
+    ASSERT_FALSE (l == o);
+    ASSERT_TRUE (l != o);
+  }
+  ASSERT_EQ (live, 0u);
+
+  {
+    comb c = spine (n);
+    comb d = c;
+    ASSERT_EQ (live, 2u * n);
+    ASSERT_TRUE (c == d);
+    get<node_t>(d).right.value = -1;
+    ASSERT_FALSE (c == d);
+  }
+  ASSERT_EQ (live, 0u);
+}
+
+TEST (pgs, iterative_copy_exception_safety) {
+
+  live = 0;
+  {
+    list l = iota (1000);
+    for (int k : {0, 1, 500, 999}) {
+      copies_left = k;
+      ASSERT_THROW (list m = l, std::runtime_error);
+      copies_left = -1;
+      ASSERT_EQ (live, 1000u);
+    }
+    comb c = spine (1000);
+    copies_left = 700;
+    ASSERT_THROW (comb d = c, std::runtime_error);
+    copies_left = -1;
+    ASSERT_EQ (live, 2000u);
+
+    //The worklist is usable after a failure
+    list m = l;
+    ASSERT_TRUE (l == m);
+  }
+  ASSERT_EQ (live, 0u);
+}
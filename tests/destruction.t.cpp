@@ -0,0 +1,88 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //Lists whose cells count their destruction
+  std::size_t destroyed = 0;
+
+  template <template <class> class W> struct cons_t;
+  struct nil_t {};
+
+  template <template <class> class W>
+  using list = sum_type<W<cons_t<W>>, nil_t>;
+
+  template <template <class> class W>
+  struct cons_t {
+    int hd;
+    list<W> tl;
+    cons_t (int hd, list<W> tl) : hd {hd}, tl (std::move (tl))
+    {}
+    ~cons_t () { ++destroyed; }
+  };
+
+  template <class T> using boxed = recursive_wrapper<T>;
+  template <class T> using shared = shared_recursive_wrapper<T>;
+
+  template <template <class> class W>
+  list<W> iota (int n) {
+    list<W> l{constructor<nil_t>{}};
+    for (int i = 0; i < n; ++i)
+      l = list<W>{constructor<cons_t<W>>{}, n - 1 - i, std::move (l)};
+    return l;
+  }
+
+  //A type that opts out
+  struct shallow_t;
+  using shallow = sum_type<recursive_wrapper<shallow_t>, nil_t>;
+  struct shallow_t {
+    shallow s;
+    explicit shallow_t (shallow s) : s (std::move (s))
+    {}
+    ~shallow_t () { ++destroyed; }
+  };
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct iterative_destruction<shallow_t> : std::false_type
+  {};
+
+}//namespace pgs
+
+TEST (pgs, iterative_destruction) {
+
+  //Deep enough to overflow the stack if destruction recursed
+  int const n = 1000000;
+
+  destroyed = 0;
+  {
+    list<boxed> l = iota<boxed> (n);
+    ASSERT_EQ (get<cons_t<boxed>>(l).hd, 0);
+  }
+  ASSERT_EQ (destroyed, static_cast<std::size_t>(n));
+
+  destroyed = 0;
+  {
+    list<shared> l = iota<shared> (n);
+    list<shared> m = l;
+    ASSERT_EQ (get<cons_t<shared>>(m).hd, 0);
+  }
+  ASSERT_EQ (destroyed, static_cast<std::size_t>(n));
+
+  //Opting out
+  destroyed = 0;
+  {
+    shallow s{constructor<nil_t>{}};
+    for (int i = 0; i < 10; ++i)
+      s = shallow{constructor<shallow_t>{}, std::move (s)};
+  }
+  ASSERT_EQ (destroyed, 10u);
+}
@@ -0,0 +1,79 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+
+  using namespace pgs;
+
+  //A sum with many cases, each case carrying its own index
+  template <std::size_t I>
+  struct op_t {
+    int n;
+    explicit op_t (int n) : n {n}
+    {}
+  };
+
+  struct halt_t;
+
+  using instr_t = sum_type<
+    op_t<0>, op_t<1>, op_t<2>, op_t<3>, op_t<4>,
+    op_t<5>, op_t<6>, op_t<7>, op_t<8>, op_t<9>,
+    op_t<10>, op_t<11>, op_t<12>, op_t<13>, op_t<14>,
+    op_t<15>, op_t<16>, op_t<17>, op_t<18>, op_t<19>,
+    op_t<20>, recursive_wrapper<halt_t>
+  >;
+
+  struct halt_t {
+    std::string why;
+    explicit halt_t (std::string const& why) : why {why}
+    {}
+  };
+
+  //Dispatch to a closure that reports the index of the case it was
+  //applied to
+  struct which {
+    template <std::size_t I>
+    std::size_t operator ()(op_t<I> const&) const { return I; }
+    std::size_t operator ()(halt_t const&) const { return 21; }
+  };
+
+}//namespace<anonymous>
+
+TEST (pgs, dispatch) {
+
+  ASSERT_EQ ((instr_t{constructor<op_t<0>>{}, 1}.match<std::size_t>(which{})), 0u);
+  ASSERT_EQ ((instr_t{constructor<op_t<7>>{}, 1}.match<std::size_t>(which{})), 7u);
+  ASSERT_EQ ((instr_t{constructor<op_t<20>>{}, 1}.match<std::size_t>(which{})), 20u);
+  ASSERT_EQ ((instr_t{constructor<halt_t>{}, "done"}.match<std::size_t>(which{})), 21u);
+
+  //The closure search still applies the first closure that accepts
+  //the active case
+  instr_t i{constructor<op_t<13>>{}, 42};
+  ASSERT_EQ (
+    i.match<int>(
+      [](op_t<13> const& o) { return o.n; },
+      [](otherwise) { return -1; }
+    ), 42);
+  ASSERT_EQ (
+    i.match<int>(
+      [](op_t<12> const& o) { return o.n; },
+      [](otherwise) { return -1; }
+    ), -1);
+
+  //non-`const` procedure
+  i.match (
+    [](op_t<13>& o) { o.n = 43; },
+    [](otherwise) {}
+  );
+  ASSERT_EQ (get<op_t<13>>(i).n, 43);
+
+  instr_t h{constructor<halt_t>{}, "halt"};
+  h.match (
+    [](halt_t& o) { o.why += "ed"; },
+    [](otherwise) {}
+  );
+  ASSERT_EQ (get<halt_t>(h).why, std::string {"halted"});
+}
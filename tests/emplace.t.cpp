@@ -0,0 +1,116 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  //A case whose construction fails on request
+  struct fuse_t {
+    int i;
+    explicit fuse_t (int i) : i {i} {
+      if (i < 0)
+        throw std::runtime_error ("fuse_t");
+    }
+  };
+
+  using atom = sum_type<int, std::string, nil_t, fuse_t>;
+
+  struct cons_t;
+  using list = sum_type<recursive_wrapper<cons_t>, nil_t>;
+  struct cons_t {
+    int hd;
+    list tl;
+    cons_t (int hd, list tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+
+  using boxed = sum_type<nil_t, recursive_wrapper<fuse_t>>;
+  using shared = sum_type<nil_t, shared_recursive_wrapper<fuse_t>>;
+  using number = sum_type<int, recursive_wrapper<fuse_t>>;
+  using flat_number = sum_type<long, recursive_wrapper<fuse_t>>;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct sum_type_storage<long, recursive_wrapper<fuse_t>> {
+    using type = flat_union<long, recursive_wrapper<fuse_t>>;
+  };
+
+}//namespace pgs
+
+TEST (pgs, emplace) {
+
+  atom a{constructor<int>{}, 1};
+  ASSERT_EQ (a.emplace<int> (2), 2);
+  ASSERT_EQ (get<int> (a), 2);
+  ASSERT_EQ (a.emplace<std::string> ("two"), "two");
+  ASSERT_EQ (get<std::string> (a), "two");
+  a.emplace<2> ();
+  ASSERT_TRUE (a.is<nil_t> ());
+  a.emplace<fuse_t> (3);
+  ASSERT_EQ (get<fuse_t> (a).i, 3);
+
+  //Boxed cases : the node of an active case is reused
+  list l{constructor<nil_t>{}};
+  l.emplace<cons_t> (1, list{constructor<nil_t>{}});
+  cons_t const* node = &get<cons_t> (l);
+  l.emplace<cons_t> (
+    2, list{constructor<cons_t>{}, 3, list{constructor<nil_t>{}}});
+  ASSERT_EQ (&get<cons_t> (l), node);
+  ASSERT_EQ (get<cons_t> (l).hd, 2);
+  ASSERT_EQ (get<cons_t> (get<cons_t> (l).tl).hd, 3);
+  l.emplace<nil_t> ();
+  ASSERT_TRUE (l.is<nil_t> ());
+
+  //Shared nodes are not
+  shared s{constructor<fuse_t>{}, 1};
+  shared t = s;
+  s.emplace<fuse_t> (2);
+  ASSERT_EQ (get<fuse_t> (s).i, 2);
+  ASSERT_EQ (get<fuse_t> (t).i, 1);
+}
+
+TEST (pgs, emplace_moved_from) {
+
+  //A sum that has been moved from has no node to reuse : one is made
+  list a{constructor<cons_t>{}, 1, list{constructor<nil_t>{}}};
+  list b{std::move (a)};
+  ASSERT_EQ (a.emplace<cons_t> (2, list{constructor<nil_t>{}}).hd, 2);
+  ASSERT_EQ (get<cons_t> (a).hd, 2);
+  ASSERT_EQ (get<cons_t> (b).hd, 1);
+
+  number n{constructor<fuse_t>{}, 1};
+  number m{std::move (n)};
+  ASSERT_EQ (n.emplace<fuse_t> (2).i, 2);
+  ASSERT_EQ (get<fuse_t> (m).i, 1);
+
+  flat_number f{constructor<fuse_t>{}, 1};
+  flat_number g{std::move (f)};
+  ASSERT_EQ (f.emplace<fuse_t> (2).i, 2);
+  ASSERT_EQ (get<fuse_t> (g).i, 1);
+}
+
+TEST (pgs, emplace_exception_safety) {
+
+  //A failure to construct leaves the active value in place
+  atom a{constructor<std::string>{}, "one"};
+  ASSERT_THROW (a.emplace<fuse_t> (-1), std::runtime_error);
+  ASSERT_EQ (get<std::string> (a), "one");
+
+  boxed b{constructor<nil_t>{}};
+  ASSERT_THROW (b.emplace<fuse_t> (-1), std::runtime_error);
+  ASSERT_TRUE (b.is<nil_t> ());
+  b.emplace<fuse_t> (1);
+  ASSERT_THROW (b.emplace<fuse_t> (-1), std::runtime_error);
+  ASSERT_EQ (get<fuse_t> (b).i, 1);
+}
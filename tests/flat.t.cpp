@@ -0,0 +1,141 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+
+  using namespace pgs;
+
+  template <class T> struct cons_t;
+  template <class T> struct nil_t {};
+
+  template <class T>
+  bool operator== (nil_t<T> const&, nil_t<T> const&) { return true; }
+
+  template <class T>
+  using list = sum_type <recursive_wrapper<cons_t<T>>, nil_t<T>>;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  //Lists use the flat representation
+  template <class T>
+  struct sum_type_storage<recursive_wrapper<cons_t<T>>, nil_t<T>> {
+    using type = flat_union<recursive_wrapper<cons_t<T>>, nil_t<T>>;
+  };
+
+}//namespace pgs
+
+namespace {
+
+  template <class T>
+  struct cons_t {
+    T hd;
+    list<T> tl;
+
+    template <class U, class V>
+    cons_t (U&& hd, V&& tl) :
+      hd {std::forward<U> (hd)}, tl {std::forward<V>(tl)} {
+    }
+  };
+
+  template <class T>
+  bool operator== (cons_t<T> const& l, cons_t<T> const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  template <class T>
+  inline list<T> nil () {
+    return list<T>{constructor<nil_t<T>>{}};
+  }
+
+  template <class U, class V>
+  inline list<decay_t<U>> cons (U&& hd, V&& tl) {
+    using T = decay_t<U>;
+    return list<T> {constructor<cons_t<T>>{}, std::forward<U> (hd), std::forward<V> (tl) };
+  }
+
+  template <class T>
+  std::size_t length (list<T> const& l) {
+    return l.template match<std::size_t>(
+      [](cons_t<T> const& c) { return 1 + length (c.tl); },
+      [](nil_t<T> const&) { return std::size_t{0}; }
+    );
+  }
+
+  //A sum with many cases
+  template <std::size_t I> struct k_t {
+    std::string s;
+    explicit k_t (std::string const& s) : s {s}
+    {}
+  };
+  template <std::size_t I>
+  bool operator== (k_t<I> const& l, k_t<I> const& r) { return l.s == r.s; }
+
+  using wide_t = sum_type<
+    k_t< 0>, k_t< 1>, k_t< 2>, k_t< 3>, k_t< 4>, k_t< 5>, k_t< 6>, k_t< 7>,
+    k_t< 8>, k_t< 9>, k_t<10>, k_t<11>, k_t<12>, k_t<13>, k_t<14>, k_t<15>,
+    k_t<16>, k_t<17>, k_t<18>, k_t<19>, k_t<20>, k_t<21>, k_t<22>, k_t<23>,
+    k_t<24>, k_t<25>, k_t<26>, k_t<27>, k_t<28>, k_t<29>, k_t<30>, k_t<31>,
+    k_t<32>, k_t<33>, k_t<34>, k_t<35>, k_t<36>, k_t<37>, k_t<38>, k_t<39>,
+    k_t<40>, k_t<41>, k_t<42>, k_t<43>, k_t<44>, k_t<45>, k_t<46>, k_t<47>,
+    k_t<48>, k_t<49>, k_t<50>, k_t<51>, k_t<52>, k_t<53>, k_t<54>, k_t<55>
+  >;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <std::size_t... Is>
+  struct sum_type_storage<k_t<Is>...> {
+    using type = flat_union<k_t<Is>...>;
+  };
+
+}//namespace pgs
+
+TEST (pgs, flat_union) {
+
+  static_assert (
+    std::is_same<
+      typename sum_type_storage<
+        recursive_wrapper<cons_t<int>>, nil_t<int>>::type
+     , flat_union<recursive_wrapper<cons_t<int>>, nil_t<int>>>::value
+   , "flat_union not selected");
+
+  list<int> l = cons (1, cons (2, cons (3, nil<int> ())));
+  ASSERT_EQ (length (l), 3u);
+  ASSERT_EQ (get<cons_t<int>>(l).hd, 1);
+  ASSERT_THROW (get<nil_t<int>>(l), invalid_sum_type_access);
+
+  //copy, compare
+  list<int> m = l;
+  ASSERT_EQ (m, l);
+  ASSERT_NE (m, cons (1, nil<int> ()));
+
+  //move, assign
+  list<int> n = std::move (m);
+  ASSERT_EQ (n, l);
+  m = nil<int> ();
+  ASSERT_TRUE (m.is<nil_t<int>>());
+  m = l;
+  ASSERT_EQ (m, l);
+}
+
+TEST (pgs, flat_union_wide) {
+
+  wide_t w{constructor<k_t<55>>{}, "last"};
+  wide_t v = w;
+  ASSERT_EQ (w, v);
+  ASSERT_EQ (get<55>(v).s, std::string {"last"});
+  ASSERT_EQ (
+    v.match<std::string>(
+      [](k_t<55> const& k) { return k.s; },
+      [](otherwise) { return std::string {}; }), std::string {"last"});
+
+  v = wide_t{constructor<k_t<0>>{}, "first"};
+  ASSERT_TRUE (v.is_type_at<0>());
+  ASSERT_NE (w, v);
+}
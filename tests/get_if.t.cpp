@@ -0,0 +1,81 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  using atom = sum_type<int, std::string, nil_t>;
+
+  struct cons_t;
+  using list = sum_type<recursive_wrapper<cons_t>, nil_t>;
+  struct cons_t {
+    int hd;
+    list tl;
+    cons_t (int hd, list tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+
+  //A handler recording the access (and throwing something else)
+  struct reported {
+    std::size_t index, active;
+  };
+
+  void report (std::size_t index, std::size_t active) {
+    throw reported {index, active};
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, get_if) {
+
+  atom a{constructor<std::string>{}, "one"};
+  ASSERT_EQ (get_if<int> (&a), nullptr);
+  ASSERT_NE (get_if<std::string> (&a), nullptr);
+  ASSERT_EQ (*get_if<std::string> (&a), "one");
+  ASSERT_EQ (get_if<1> (&a), &get<1> (a));
+  *get_if<1> (&a) = "two";
+  ASSERT_EQ (get<std::string> (a), "two");
+
+  atom const& c = a;
+  ASSERT_EQ (get_if<nil_t> (&c), nullptr);
+  ASSERT_EQ (*get_if<std::string> (&c), "two");
+
+  atom* none = nullptr;
+  ASSERT_EQ (get_if<int> (none), nullptr);
+
+  //Through a `recursive_wrapper<>`
+  list l{constructor<cons_t>{}, 1, list{constructor<nil_t>{}}};
+  ASSERT_EQ (get_if<cons_t> (&l)->hd, 1);
+  ASSERT_EQ (get_if<nil_t> (&get_if<cons_t> (&l)->tl)
+           , &get<nil_t> (get<cons_t> (l).tl));
+  ASSERT_EQ (get_if<cons_t> (&get<cons_t> (l).tl), nullptr);
+}
+
+TEST (pgs, invalid_access_handler) {
+
+  atom a{constructor<int>{}, 1};
+  ASSERT_THROW (get<std::string> (a), invalid_sum_type_access);
+
+  invalid_access_handler previous = set_invalid_access_handler (&report);
+  ASSERT_EQ (get_invalid_access_handler (), &report);
+  try {
+    get<nil_t> (a);
+    FAIL ();
+  }
+  catch (reported const& r) {
+    ASSERT_EQ (r.index, 2u);
+    ASSERT_EQ (r.active, 0u);
+  }
+
+  //`nullptr` restores the default
+  set_invalid_access_handler (nullptr);
+  ASSERT_EQ (get_invalid_access_handler (), previous);
+  ASSERT_THROW (get<std::string> (a), invalid_sum_type_access);
+}
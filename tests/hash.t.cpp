@@ -0,0 +1,138 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+  struct node_t;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct cached_hash<node_t> : std::true_type
+  {};
+
+}//namespace pgs
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+  bool operator== (nil_t const&, nil_t const&) { return true; }
+
+  //Atoms (in the union representation)
+  using atom = sum_type<int, std::string, nil_t>;
+
+  //Lists (in the tagged pointer representation)
+  struct cons_t;
+  using list = sum_type<recursive_wrapper<cons_t>, nil_t>;
+  struct cons_t {
+    int hd;
+    list tl;
+    cons_t (int hd, list tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+  bool operator== (cons_t const& l, cons_t const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  list iota (int lo, int hi) {
+    list l{constructor<nil_t>{}};
+    for (int i = hi; i-- > lo;)
+      l = list{constructor<cons_t>{}, i, std::move (l)};
+    return l;
+  }
+
+  //Trees whose nodes cache their hash
+  std::size_t node_compares = 0;
+
+  using tree = sum_type<nil_t, shared_recursive_wrapper<node_t>>;
+  struct node_t {
+    tree l;
+    int v;
+    tree r;
+    node_t (tree l, int v, tree r)
+      : l (std::move (l)), v {v}, r (std::move (r))
+    {}
+  };
+  bool operator== (node_t const& x, node_t const& y) {
+    ++node_compares;
+    return x.v == y.v && x.l == y.l && x.r == y.r;
+  }
+
+  //A balanced tree of [lo, hi) (but for `odd`, which is negated)
+  tree build (int lo, int hi, int odd) {
+    if (lo == hi)
+      return tree{constructor<nil_t>{}};
+    int const mid = lo + (hi - lo) / 2;
+    return tree{constructor<node_t>{}
+      , build (lo, mid, odd), mid == odd ? -mid : mid, build (mid + 1, hi, odd)};
+  }
+
+}//namespace<anonymous>
+
+namespace std {
+
+  template <>
+  struct hash<cons_t> {
+    std::size_t operator () (cons_t const& c) const {
+      return pgs::hash_combine (hash<int>{}(c.hd), hash<list>{}(c.tl));
+    }
+  };
+
+  template <>
+  struct hash<node_t> {
+    std::size_t operator () (node_t const& n) const {
+      return pgs::hash_combine (pgs::hash_combine (
+          hash<tree>{}(n.l), hash<int>{}(n.v)), hash<tree>{}(n.r));
+    }
+  };
+
+}//namespace std
+
+TEST (pgs, hash) {
+
+  std::unordered_set<atom> atoms;
+  atoms.insert (atom{constructor<int>{}, 1});
+  atoms.insert (atom{constructor<std::string>{}, "one"});
+  atoms.insert (atom{constructor<nil_t>{}});
+  atoms.insert (atom{constructor<int>{}, 1});
+  atoms.insert (atom{constructor<nil_t>{}});
+  ASSERT_EQ (atoms.size (), 3u);
+  ASSERT_EQ (atoms.count (atom{constructor<std::string>{}, "one"}), 1u);
+  ASSERT_EQ (atoms.count (atom{constructor<std::string>{}, "two"}), 0u);
+
+  std::hash<list> h;
+  ASSERT_EQ (h (iota (0, 100)), h (iota (0, 100)));
+  ASSERT_NE (h (iota (0, 100)), h (iota (1, 100)));
+  std::unordered_set<list> lists {iota (0, 10), iota (0, 10), iota (0, 11)};
+  ASSERT_EQ (lists.size (), 2u);
+}
+
+TEST (pgs, cached_hash) {
+
+  int const n = 1 << 12;
+  tree t = build (0, n, -1);
+  tree u = build (0, n, -1);
+  tree v = build (0, n, n - 1);
+  std::hash<tree> h;
+  ASSERT_EQ (h (t), h (u));
+  ASSERT_NE (h (t), h (v));
+
+  //The hashes differ at the root : the values are not examined
+  node_compares = 0;
+  ASSERT_FALSE (t == v);
+  ASSERT_EQ (node_compares, 0u);
+
+  //Equal values are examined (equal hashes may be a collision)
+  ASSERT_TRUE (t == u);
+  ASSERT_EQ (node_compares, static_cast<std::size_t>(n));
+}
@@ -0,0 +1,129 @@
+#include <pgs/hash_cons.hpp> //first : the header stands alone
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  //Expressions whose additions are interned
+  struct cst_t {
+    int i;
+    explicit cst_t (int i) : i {i}
+    {}
+  };
+  bool operator== (cst_t const& l, cst_t const& r) { return l.i == r.i; }
+
+  struct add_t;
+  struct add_hash;
+  using xpr_t = sum_type<cst_t, interned<add_t, add_hash>>;
+
+  struct add_t {
+    xpr_t l, r;
+    add_t (xpr_t l, xpr_t r) : l (std::move (l)), r (std::move (r))
+    {}
+  };
+  bool operator== (add_t const& x, add_t const& y) {
+    return x.l == y.l && x.r == y.r;
+  }
+
+  //Children are hashed by value (constants) or by address (interned
+  //nodes)
+  std::size_t shallow_hash (xpr_t const& x) {
+    return x.match<std::size_t>(
+      [](cst_t const& c) { return std::hash<int>{}(c.i); },
+      [](add_t const& a) { return std::hash<add_t const*>{}(&a); });
+  }
+
+  struct add_hash {
+    std::size_t operator () (add_t const& a) const {
+      return shallow_hash (a.l) * 31 + shallow_hash (a.r);
+    }
+  };
+
+  using add_cons = hash_cons<add_t, add_hash>;
+
+  xpr_t cst (int i) {
+    return xpr_t{constructor<cst_t>{}, i};
+  }
+
+  xpr_t add (xpr_t l, xpr_t r) {
+    return xpr_t{constructor<add_t>{}
+      , add_cons::make (std::move (l), std::move (r))};
+  }
+
+  add_t const* node (xpr_t const& x) {
+    return x.match<add_t const*>(
+      [](cst_t const&) -> add_t const* { return nullptr; },
+      [](add_t const& a) { return &a; });
+  }
+
+  //(((1 + 2) + 3) + ... + n)
+  xpr_t sum (int n) {
+    xpr_t x = cst (1);
+    for (int i = 2; i <= n; ++i)
+      x = add (std::move (x), cst (i));
+    return x;
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, hash_cons) {
+
+  ASSERT_EQ (add_cons::size (), 0u);
+  {
+    xpr_t x = add (cst (2), cst (3));
+    xpr_t y = add (cst (2), cst (3));
+    xpr_t z = add (cst (3), cst (2));
+    ASSERT_EQ (node (x), node (y));
+    ASSERT_NE (node (x), node (z));
+    ASSERT_EQ (add_cons::size (), 2u);
+
+    //Sharing is maximal
+    std::vector<xpr_t> xs;
+    for (int i = 0; i < 100; ++i)
+      xs.push_back (sum (50));
+    ASSERT_EQ (add_cons::size (), 2u + 49u);
+    for (xpr_t const& x : xs)
+      ASSERT_EQ (node (x), node (xs.front ()));
+
+    xpr_t w = add (x, x);
+    ASSERT_EQ (node (w), node (add (y, y)));
+  }
+
+  //The table is weak
+  ASSERT_EQ (add_cons::size (), 0u);
+  {
+    xpr_t x = add (cst (2), cst (3));
+    ASSERT_EQ (add_cons::size (), 1u);
+  }
+  ASSERT_EQ (add_cons::size (), 0u);
+}
+
+TEST (pgs, hash_cons_concurrent) {
+
+  //Threads intern (and drop) the same nodes
+  std::vector<add_t const*> roots (8);
+  {
+    std::vector<std::thread> threads;
+    std::vector<xpr_t> kept (roots.size (), cst (0));
+    for (std::size_t t = 0; t < roots.size (); ++t)
+      threads.emplace_back ([t, &roots, &kept]() {
+          for (int i = 0; i < 200; ++i)
+            kept[t] = sum (i % 20 + 2);
+          roots[t] = node (kept[t]);
+        });
+    for (std::thread& t : threads)
+      t.join ();
+    for (add_t const* root : roots)
+      ASSERT_EQ (root, roots.front ());
+    ASSERT_EQ (add_cons::size (), 20u);
+  }
+  ASSERT_EQ (add_cons::size (), 0u);
+}
@@ -0,0 +1,95 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+  using namespace pgs;
+
+  template <class T>
+  struct some_t {
+    T data;
+    explicit some_t (T data) : data {data}
+    {}
+  };
+  template <class T>
+  bool operator== (some_t<T> const& l, some_t<T> const& r) {
+    return l.data == r.data;
+  }
+
+  struct none_t {};
+
+  template <class T>
+  using option = sum_type<some_t<T>, none_t>;
+
+  //The largest case (9 bytes) is smaller than the storage (16 bytes,
+  //the alignment of `std::int64_t` being 8)
+  struct bytes_t {
+    char data[9];
+    explicit bytes_t (char c) { for (char& d : data) d = c; }
+  };
+  bool operator== (bytes_t const& l, bytes_t const& r) {
+    return std::equal (l.data, l.data + 9, r.data);
+  }
+
+  struct word_t {
+    std::int64_t data;
+    explicit word_t (std::int64_t data) : data {data}
+    {}
+  };
+  bool operator== (word_t const& l, word_t const& r) {
+    return l.data == r.data;
+  }
+
+  using packed_t = sum_type<bytes_t, word_t>;
+
+}//namespace<anonymous>
+
+TEST (pgs, layout) {
+
+  //A single byte suffices for the index of small sums
+  static_assert (
+    std::is_same<sum_type_layout<some_t<int>, none_t>::index_type
+                 , unsigned char>::value, "");
+
+  //The index no longer costs a `std::size_t`
+  static_assert (sizeof (option<int>) == 2 * sizeof (int), "");
+  static_assert (
+    sum_type_layout<some_t<int>, none_t>::size == sizeof (option<int>), "");
+  static_assert (
+    !sum_type_layout<some_t<int>, none_t>::index_in_padding, "");
+
+  //The index goes into the padding of the storage
+  static_assert (sum_type_layout<bytes_t, word_t>::index_in_padding, "");
+  static_assert (sizeof (packed_t) == 16, "");
+
+  option<int> o{constructor<some_t<int>>{}, 3};
+  ASSERT_TRUE (o.is<some_t<int>>());
+  ASSERT_EQ (get<some_t<int>>(o).data, 3);
+  o = option<int>{constructor<none_t>{}};
+  ASSERT_TRUE (o.is<none_t>());
+
+  packed_t p{constructor<bytes_t>{}, 'x'};
+  ASSERT_TRUE (p.is_type_at<0>());
+  ASSERT_EQ (get<0>(p).data[8], 'x');
+  packed_t q{constructor<word_t>{}, -1};
+  ASSERT_TRUE (q.is_type_at<1>());
+  ASSERT_EQ (get<1>(q).data, -1);
+
+  //Writing a case leaves the index intact and vice-versa
+  p = q;
+  ASSERT_TRUE (p.is_type_at<1>());
+  ASSERT_EQ (p, q);
+  q = packed_t{constructor<bytes_t>{}, '\xff'};
+  ASSERT_TRUE (q.is_type_at<0>());
+  ASSERT_EQ (
+    q.match<char>(
+      [](bytes_t const& b) { return b.data[8]; },
+      [](word_t const&) { return '\0'; }), '\xff');
+  packed_t r = std::move (q);
+  ASSERT_TRUE (r.is_type_at<0>());
+  ASSERT_NE (p, r);
+}
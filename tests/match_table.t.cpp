@@ -0,0 +1,96 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  //A case that cannot be copied
+  struct unique_t {
+    std::unique_ptr<int> p;
+    explicit unique_t (int i) : p {new int {i}}
+    {}
+  };
+
+  using value = sum_type<int, std::string, unique_t, nil_t>;
+
+  struct on_int { int operator () (int const&) const { return 0; } };
+  struct on_string { int operator () (std::string const&) const { return 1; } };
+  struct on_unique { int operator () (unique_t const& u) const { return *u.p; } };
+  struct on_nil { int operator () (nil_t const&) const { return 3; } };
+  struct on_any { int operator () (otherwise) const { return -1; } };
+  struct on_string_ref { int operator () (std::string&) const { return 4; } };
+
+  template <class... Fs>
+  using const_table = match_table<
+    std::tuple<int const&, std::string const&, unique_t const&, nil_t const&>
+  , Fs...>;
+
+  template <class... Fs>
+  using table = match_table<
+    std::tuple<int&, std::string&, unique_t&, nil_t&>, Fs...>;
+
+}//namespace<anonymous>
+
+TEST (pgs, match_table) {
+
+  //Each case goes to the first handler that accepts it
+  using cover = const_table<on_nil, on_int, on_string, on_unique>;
+  static_assert (cover::handler[0] == 1, "");
+  static_assert (cover::handler[1] == 2, "");
+  static_assert (cover::handler[2] == 3, "");
+  static_assert (cover::handler[3] == 0, "");
+  static_assert (cover::exhaustive && cover::irredundant, "");
+
+  //A case without a handler
+  using partial = const_table<on_int, on_string>;
+  static_assert (partial::handler[2] == no_handler, "");
+  static_assert (!partial::exhaustive, "");
+  static_assert (partial::irredundant, "");
+
+  //A handler shadowed by an earlier one
+  using shadowed = const_table<on_any, on_int>;
+  static_assert (shadowed::exhaustive, "");
+  static_assert (!shadowed::irredundant, "");
+
+  //A default that handles nothing is not redundant
+  using defaulted = const_table<on_int, on_string, on_unique, on_nil, on_any>;
+  static_assert (defaulted::handler[3] == 3, "");
+  static_assert (defaulted::irredundant, "");
+
+  //`const`-ness counts : a handler of a `std::string&` does not accept
+  //a `std::string const&`
+  using mutating = const_table<on_string_ref, on_any>;
+  static_assert (mutating::handler[1] == 1, "");
+  static_assert (!mutating::irredundant, "");
+  using mutated = table<on_string_ref, on_any>;
+  static_assert (mutated::handler[1] == 0, "");
+  static_assert (mutated::irredundant, "");
+
+  //Dispatch goes through the table
+  value u{constructor<unique_t>{}, 2};
+  ASSERT_EQ (u.match<int>(on_int{}, on_string{}, on_unique{}, on_nil{}), 2);
+  ASSERT_EQ (u.match<int>(on_string{}, on_any{}), -1);
+
+  value s{constructor<std::string>{}, "s"};
+  ASSERT_EQ (s.match<int>(on_string_ref{}, on_any{}), 4);
+  value const& c = s;
+  ASSERT_EQ (c.match<int>(on_string{}, on_any{}), 1);
+
+  //Handlers passed as lvalues
+  on_int i;
+  on_any a;
+  ASSERT_EQ (s.match<int>(i, a), -1);
+  int n = 0;
+  s.match (
+    [&n](std::string& str) { n = static_cast<int> (str.size ()); },
+    a);
+  ASSERT_EQ (n, 1);
+}
@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 namespace {
   using namespace pgs;
   
@@ -60,3 +62,77 @@ TEST (pgs, move_assign) {
 
   ASSERT_TRUE(true);
 }
+
+TEST (pgs, move_steals) {
+  static_assert (
+    std::is_nothrow_move_constructible<recursive_wrapper<cons<foo>>>::value, "");
+  static_assert (std::is_nothrow_move_constructible<list<foo>>::value, "");
+  static_assert (std::is_nothrow_move_assignable<list<foo>>::value, "");
+  //Also when the storage is a `recursive_union<>`
+  static_assert (
+    std::is_nothrow_move_constructible<
+      sum_type<recursive_wrapper<cons<foo>>, int>>::value, "");
+
+  //Moving a wrapper hands over the allocation
+  recursive_wrapper<cons<int>> w{1, list<int>{constructor<nil<int>>{}}};
+  cons<int> const* p = w.get_pointer ();
+  recursive_wrapper<cons<int>> v = std::move (w);
+  ASSERT_EQ (v.get_pointer (), p);
+  //A moved from wrapper can be assigned to
+  w = v;
+  ASSERT_EQ (w.get ().hd, 1);
+  ASSERT_NE (w.get_pointer (), p);
+
+  //Growing a vector of sums moves no payloads
+  std::vector<list<foo>> ls;
+  ls.push_back (singleton ());
+  foo_copy_detected = foo_move_detected = false;
+  for (int i = 0; i < 64; ++i) {
+    ls.push_back (list<foo>{constructor<nil<foo>>{}});
+  }
+  ASSERT_TRUE (!foo_move_detected && !foo_copy_detected);
+  ASSERT_TRUE (ls[0].is_type_at<0>());
+}
+
+TEST (pgs, move_null_state) {
+  using ulist = sum_type<recursive_wrapper<cons<int>>, int>;
+  static_assert (sizeof (list<int>) == sizeof (void*), "tagged storage");
+
+  list<int> const empty{constructor<nil<int>>{}};
+  list<int> const one{constructor<cons<int>>{}, 1, empty};
+
+  //A sum that has been moved from can be copy-assigned to...
+  list<int> l = one;
+  list<int> m = std::move (l);
+  l = one;
+  ASSERT_EQ (get<cons<int>> (l).hd, 1);
+  //...move-assigned to...
+  m = std::move (l);
+  l = list<int>{constructor<cons<int>>{}, 2, empty};
+  ASSERT_EQ (get<cons<int>> (l).hd, 2);
+  m = std::move (l);
+  l = list<int>{constructor<nil<int>>{}};
+  ASSERT_TRUE (l.is<nil<int>> ());
+  //...and emplaced into (the active case or another)
+  m = std::move (l);
+  m = one;
+  l = std::move (m);
+  ASSERT_EQ (m.emplace<cons<int>> (3, empty).hd, 3);
+  l = std::move (m);
+  m.emplace<nil<int>> ();
+  ASSERT_TRUE (m.is<nil<int>> ());
+
+  //Also when the storage is a `recursive_union<>`
+  ulist u{constructor<cons<int>>{}, 1, empty};
+  ulist v = std::move (u);
+  u = v;
+  ASSERT_EQ (get<cons<int>> (u).hd, 1);
+  v = std::move (u);
+  u = ulist{constructor<int>{}, 2};
+  ASSERT_EQ (get<int> (u), 2);
+  u = std::move (v);
+  ASSERT_EQ (v.emplace<cons<int>> (4, empty).hd, 4);
+  u = std::move (v);
+  v.emplace<int> (5);
+  ASSERT_EQ (get<int> (v), 5);
+}
@@ -0,0 +1,111 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  struct E_const;
+  struct E_add;
+
+  using xpr_t = sum_type<recursive_wrapper<E_const>, recursive_wrapper<E_add>>;
+
+  struct E_const {
+    int i;
+    explicit E_const (int i) : i {i}
+    {}
+  };
+
+  struct E_add {
+    xpr_t l, r;
+    E_add (xpr_t const& l, xpr_t const& r) : l {l}, r {r}
+    {}
+  };
+
+  inline xpr_t cst (int i) {
+    return xpr_t{constructor<E_const>{}, i};
+  }
+
+  inline xpr_t add (xpr_t const& l, xpr_t const& r) {
+    return xpr_t{constructor<E_add>{}, l, r};
+  }
+
+  //Fold constant additions : the operands are examined together
+  xpr_t simplify (xpr_t const& e) {
+    return e.match<xpr_t>(
+      [](E_const const& c) { return cst (c.i); },
+      [](E_add const& a) {
+        xpr_t l = simplify (a.l), r = simplify (a.r);
+        return match<xpr_t>(l, r,
+          [](E_const const& x, E_const const& y) { return cst (x.i + y.i); },
+          [&](otherwise, otherwise) { return add (l, r); });
+      });
+  }
+
+  struct nil_t {};
+  using atom = sum_type<int, std::string, nil_t>;
+
+  int rank (atom const& u) {
+    return u.match<int>(
+      [](int) { return 0; },
+      [](std::string const&) { return 1; },
+      [](nil_t) { return 2; });
+  }
+
+  //Atoms of different cases compare by case
+  int compare (atom const& u, atom const& v) {
+    return match<int>(u, v,
+      [](int x, int y) { return x < y ? -1 : y < x ? 1 : 0; },
+      [](std::string const& x, std::string const& y) { return x.compare (y); },
+      [](nil_t, nil_t) { return 0; },
+      [&](otherwise, otherwise) {
+        return rank (u) < rank (v) ? -1 : 1;
+      });
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, multi_match) {
+
+  xpr_t e = add (add (cst (1), cst (2)), add (cst (3), cst (4)));
+  xpr_t s = simplify (e);
+  ASSERT_TRUE (s.is<E_const>());
+  ASSERT_EQ (get<E_const>(s).i, 10);
+
+  xpr_t t = simplify (add (cst (1), add (cst (2), e)));
+  ASSERT_EQ (get<E_const>(t).i, 13);
+
+  atom i{constructor<int>{}, 1}, j{constructor<int>{}, 2};
+  atom a{constructor<std::string>{}, "a"}, b{constructor<std::string>{}, "b"};
+  atom n{constructor<nil_t>{}};
+  ASSERT_EQ (compare (i, j), -1);
+  ASSERT_EQ (compare (j, i), 1);
+  ASSERT_EQ (compare (b, a), 1);
+  ASSERT_EQ (compare (n, n), 0);
+  ASSERT_EQ (compare (i, a), -1);
+  ASSERT_EQ (compare (n, a), 1);
+
+  //Three sums, non-`const` payloads
+  atom x{constructor<std::string>{}, "x"};
+  match (x, a, n,
+    [](std::string& p, std::string const& q, nil_t) { p += q; },
+    [](otherwise, otherwise, otherwise) {});
+  ASSERT_EQ (get<std::string>(x), std::string {"xa"});
+
+  //The handler of a combination is the first that accepts it
+  ASSERT_EQ ((match<int>(i, a,
+    [](int, std::string const&) { return 1; },
+    [](int, otherwise) { return 2; },
+    [](otherwise, otherwise) { return 3; })), 1);
+  ASSERT_EQ ((match<int>(i, n,
+    [](int, std::string const&) { return 1; },
+    [](int, otherwise) { return 2; },
+    [](otherwise, otherwise) { return 3; })), 2);
+
+  //A single sum
+  ASSERT_EQ (match<int>(a, [](otherwise) { return 4; }), 4);
+}
@@ -0,0 +1,189 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  struct cons_t;
+  struct lists_t;
+  struct node_t;
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  template <>
+  struct iterative_ordering<cons_t> : std::true_type
+  {};
+
+  template <>
+  struct iterative_ordering<lists_t> : std::true_type
+  {};
+
+  //Wrongly : trees nest two values of the type
+  template <>
+  struct iterative_ordering<node_t> : std::true_type
+  {};
+
+}//namespace pgs
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+  bool operator== (nil_t const&, nil_t const&) { return true; }
+
+  //Atoms (in the union representation)
+  using atom = sum_type<int, std::string, nil_t>;
+
+  atom num (int i) { return atom{constructor<int>{}, i}; }
+  atom str (char const* s) { return atom{constructor<std::string>{}, s}; }
+  atom nil () { return atom{constructor<nil_t>{}}; }
+
+  //Lists (in the tagged pointer representation) ordered
+  //lexicographically
+  using list = sum_type<nil_t, recursive_wrapper<cons_t>>;
+  struct cons_t {
+    int hd;
+    list tl;
+    cons_t (int hd, list tl) : hd {hd}, tl (std::move (tl))
+    {}
+  };
+  bool operator== (cons_t const& l, cons_t const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+  bool operator< (cons_t const& l, cons_t const& r) {
+    return l.hd < r.hd || (!(r.hd < l.hd) && l.tl < r.tl);
+  }
+
+  //[0, n) (but for the last element, `end`)
+  list iota (int n, int end) {
+    list l{constructor<nil_t>{}};
+    for (int i = n; i-- > 0;)
+      l = list{constructor<cons_t>{}, i == n - 1 ? end : i, std::move (l)};
+    return l;
+  }
+
+  //Lists of lists (both ordered iteratively)
+  using lists = sum_type<nil_t, recursive_wrapper<lists_t>>;
+  struct lists_t {
+    list hd;
+    lists tl;
+    lists_t (list hd, lists tl) : hd (std::move (hd)), tl (std::move (tl))
+    {}
+  };
+  bool operator< (lists_t const& l, lists_t const& r) {
+    return l.hd < r.hd || (!(r.hd < l.hd) && l.tl < r.tl);
+  }
+
+  lists cons (list hd, lists tl) {
+    return lists{constructor<lists_t>{}, std::move (hd), std::move (tl)};
+  }
+
+  //Trees (that don't meet the requirements of `iterative_ordering<>`)
+  using tree = sum_type<nil_t, recursive_wrapper<node_t>>;
+  struct node_t {
+    tree l, r;
+    node_t (tree l, tree r) : l (std::move (l)), r (std::move (r))
+    {}
+  };
+  bool operator< (node_t const& l, node_t const& r) {
+    return l.l < r.l || (!(r.l < l.l) && l.r < r.r);
+  }
+
+  tree node (tree l, tree r) {
+    return tree{constructor<node_t>{}, std::move (l), std::move (r)};
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, ordering) {
+
+  std::vector<atom> atoms {str ("b"), nil (), num (2), str ("a"), num (1)};
+  std::sort (atoms.begin (), atoms.end ());
+  std::vector<atom> sorted {num (1), num (2), str ("a"), str ("b"), nil ()};
+  ASSERT_TRUE (atoms == sorted);
+
+  ASSERT_TRUE (num (1) < num (2));
+  ASSERT_TRUE (num (2) > num (1));
+  ASSERT_TRUE (num (1) <= num (1));
+  ASSERT_TRUE (num (1) >= num (1));
+  ASSERT_FALSE (nil () < nil ());
+  ASSERT_TRUE (num (100) < str (""));
+#if defined (__cpp_impl_three_way_comparison) \
+  && __cpp_impl_three_way_comparison >= 201907L
+  ASSERT_TRUE ((num (1) <=> num (2)) < 0);
+  ASSERT_TRUE ((nil () <=> nil ()) == 0);
+#endif
+
+  std::set<atom> set {num (3), num (3), str ("x"), nil (), nil ()};
+  ASSERT_EQ (set.size (), 3u);
+
+  std::map<list, int> map;
+  map[iota (3, 2)] = 1;
+  map[iota (2, 1)] = 2;
+  map[iota (3, 2)] = 3;
+  ASSERT_EQ (map.size (), 2u);
+  ASSERT_EQ (map.begin ()->second, 2);
+}
+
+TEST (pgs, iterative_ordering) {
+
+  //Deep enough to overflow the stack if ordering recursed
+  int const n = 1000000;
+
+  list l = iota (n, n - 1);
+  list m = iota (n, n);
+  list p = iota (n - 1, n - 2);
+  ASSERT_TRUE (l < m);
+  ASSERT_FALSE (m < l);
+  ASSERT_FALSE (l < l);
+  ASSERT_TRUE (p < l);
+  ASSERT_FALSE (l < p);
+}
+
+TEST (pgs, iterative_ordering_nested) {
+
+  lists const nil{constructor<nil_t>{}};
+
+  //[[0, 1], [0]] and [[0, 1], [1]]
+  lists c = cons (iota (2, 1), cons (iota (1, 0), nil));
+  lists d = cons (iota (2, 1), cons (iota (1, 1), nil));
+  ASSERT_TRUE (c < d);
+  ASSERT_FALSE (d < c);
+  ASSERT_FALSE (c < c);
+
+  //[[0, 2]] and [[0, 1], [0]] : decided by the heads
+  lists e = cons (iota (2, 2), nil);
+  ASSERT_TRUE (c < e);
+  ASSERT_FALSE (e < c);
+
+  //Long lists of long lists
+  int const n = 100000;
+  lists l = nil, m = nil;
+  for (int i = 0; i < 10; ++i) {
+    l = cons (iota (n, n - 1), std::move (l));
+    m = cons (iota (n, i == 0 ? n : n - 1), std::move (m));
+  }
+  ASSERT_TRUE (l < m);
+  ASSERT_FALSE (m < l);
+  ASSERT_FALSE (l < l);
+}
+
+TEST (pgs, iterative_ordering_contract) {
+
+  tree const leaf{constructor<nil_t>{}};
+  tree const t = node (node (leaf, leaf), leaf);
+  tree const u = node (node (leaf, leaf), leaf);
+
+  //Ordering a second nested value is caught (in every build)
+  ASSERT_DEATH (t < u, "iterative_ordering");
+}
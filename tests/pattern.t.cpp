@@ -0,0 +1,204 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //Trees
+  struct empty_t {};
+  struct node_t;
+
+  using tree = sum_type<empty_t, recursive_wrapper<node_t>>;
+
+  struct node_t {
+    std::pair<int, std::string> data;
+    tree left_child, right_child;
+
+    node_t (std::pair<int, std::string> const& data
+          , tree const& left_child, tree const& right_child)
+      : data {data}, left_child {left_child}, right_child {right_child}
+    {}
+  };
+
+  //Expressions
+  struct E_const;
+  struct E_add;
+  struct E_mul;
+
+  using xpr_t = sum_type<
+      recursive_wrapper<E_const>
+    , recursive_wrapper<E_add>
+    , recursive_wrapper<E_mul>>;
+
+  struct E_const {
+    int i;
+    explicit E_const (int i) : i {i}
+    {}
+  };
+
+  struct E_add {
+    xpr_t l, r;
+    E_add (xpr_t const& l, xpr_t const& r) : l {l}, r {r}
+    {}
+  };
+
+  struct E_mul {
+    xpr_t l, r;
+    E_mul (xpr_t const& l, xpr_t const& r) : l {l}, r {r}
+    {}
+  };
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  //The sub-trees of a node
+  template <>
+  struct pattern_fields<node_t> {
+    static std::tuple<tree const&, tree const&> get (node_t const& n) {
+      return std::tie (n.left_child, n.right_child);
+    }
+  };
+
+  //The operands of the binary expressions
+  template <>
+  struct pattern_fields<E_add> {
+    static std::tuple<xpr_t const&, xpr_t const&> get (E_add const& e) {
+      return std::tie (e.l, e.r);
+    }
+  };
+
+  template <>
+  struct pattern_fields<E_mul> {
+    static std::tuple<xpr_t const&, xpr_t const&> get (E_mul const& e) {
+      return std::tie (e.l, e.r);
+    }
+  };
+
+}//namespace pgs
+
+namespace {
+
+  tree leaf () {
+    return tree{constructor<empty_t>{}};
+  }
+
+  tree node (int k, tree const& l, tree const& r) {
+    return tree{constructor<node_t>{}, std::make_pair (k, std::to_string (k)), l, r};
+  }
+
+  using binding = std::pair<int, std::string>;
+
+  //The node whose left child is empty holds the least binding
+  binding const& min_binding (tree const& t) {
+    return match_rules<binding const&>(t,
+      rule (case_of<node_t>(case_of<empty_t>(), var),
+        [](node_t const& n, empty_t const&, tree const&) -> binding const& {
+          return n.data;
+        }),
+      rule (case_of<node_t>(),
+        [](node_t const& n) -> binding const& {
+          return min_binding (n.left_child);
+        }),
+      rule (case_of<empty_t>(),
+        [](empty_t const&) -> binding const& {
+          throw std::runtime_error {"min_binding"};
+        }));
+  }
+
+  xpr_t cst (int i) {
+    return xpr_t{constructor<E_const>{}, i};
+  }
+
+  xpr_t add (xpr_t const& l, xpr_t const& r) {
+    return xpr_t{constructor<E_add>{}, l, r};
+  }
+
+  xpr_t mul (xpr_t const& l, xpr_t const& r) {
+    return xpr_t{constructor<E_mul>{}, l, r};
+  }
+
+  //Rewrite rules : constant folding and the neutral and absorbing
+  //elements (one rewrite, at the root)
+  xpr_t rewrite (xpr_t const& e) {
+    return match_rules<xpr_t>(e,
+      rule (case_of<E_add>(case_of<E_const>(), case_of<E_const>()),
+        [](E_add const&, E_const const& x, E_const const& y) {
+          return cst (x.i + y.i);
+        }),
+      rule (case_of<E_add>(case_of<E_const>(), var),
+        [](E_add const&, E_const const& x, xpr_t const&) {
+          return x.i == 0;
+        },
+        [](E_add const&, E_const const&, xpr_t const& y) {
+          return y;
+        }),
+      rule (case_of<E_mul>(case_of<E_const>(), var),
+        [](E_mul const&, E_const const& x, xpr_t const&) {
+          return x.i == 0;
+        },
+        [](E_mul const&, E_const const&, xpr_t const&) {
+          return cst (0);
+        }),
+      rule (var,
+        [](xpr_t const& x) {
+          return x;
+        }));
+  }
+
+  //The number of nodes of a tree whose children are both empty
+  int leaves (tree const& t) {
+    return match_rules<int>(t,
+      rule (case_of<node_t>(case_of<empty_t>(), case_of<empty_t>()),
+        [](node_t const&, empty_t const&, empty_t const&) { return 1; }),
+      rule (case_of<node_t>(var, var),
+        [](node_t const&, tree const& l, tree const& r) {
+          return leaves (l) + leaves (r);
+        }),
+      rule (var, [](tree const&) { return 0; }));
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, pattern) {
+
+  tree t = node (5, node (3, node (1, leaf (), leaf ()), leaf ()), node (8, leaf (), leaf ()));
+  ASSERT_EQ (min_binding (t).first, 1);
+  ASSERT_EQ (min_binding (node (2, leaf (), leaf ())).first, 2);
+  ASSERT_THROW (min_binding (leaf ()), std::runtime_error);
+  ASSERT_EQ (leaves (t), 2);
+  ASSERT_EQ (leaves (leaf ()), 0);
+
+  //Folding
+  xpr_t a = rewrite (add (cst (2), cst (3)));
+  ASSERT_EQ (get<E_const>(a).i, 5);
+
+  //A guard that holds...
+  xpr_t b = rewrite (add (cst (0), mul (cst (2), cst (3))));
+  ASSERT_TRUE (b.is<E_mul>());
+  xpr_t c = rewrite (mul (cst (0), add (cst (2), cst (3))));
+  ASSERT_EQ (get<E_const>(c).i, 0);
+
+  //...and one that does not : the next rule applies
+  xpr_t d = rewrite (mul (cst (1), cst (4)));
+  ASSERT_TRUE (d.is<E_mul>());
+  xpr_t f = rewrite (add (cst (1), mul (cst (2), cst (3))));
+  ASSERT_TRUE (f.is<E_add>());
+
+  //Procedures
+  int n = 0;
+  match_rules (t,
+    rule (case_of<node_t>(var, case_of<node_t>()),
+      [&n](node_t const& x, tree const&, node_t const& y) {
+        n = x.data.first + y.data.first;
+      }),
+    rule (var, [](tree const&) {}));
+  ASSERT_EQ (n, 13);
+}
@@ -0,0 +1,126 @@
+#include <pgs/pool.hpp> //first : the header stands alone
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+  using namespace pgs;
+
+  template <class T> struct cons_t;
+  struct nil_t {};
+  bool operator== (nil_t const&, nil_t const&) { return true; }
+
+  template <class T>
+  using list =
+    sum_type<recursive_wrapper<cons_t<T>, pool_allocator<cons_t<T>>>, nil_t>;
+
+  template <class T>
+  struct cons_t {
+    T hd;
+    list<T> tl;
+
+    template <class U, class V>
+    cons_t (U&& hd, V&& tl) :
+      hd {std::forward<U> (hd)}, tl {std::forward<V>(tl)} {
+    }
+  };
+
+  template <class T>
+  bool operator== (cons_t<T> const& l, cons_t<T> const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  template <class T>
+  list<T> iota (T n) {
+    list<T> l{constructor<nil_t>{}};
+    for (T i = 0; i < n; ++i)
+      l = list<T>{constructor<cons_t<T>>{}, n - 1 - i, std::move (l)};
+    return l;
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, pool_allocator) {
+
+  using stats = pool_allocator<cons_t<int>>;
+
+  //The allocator being stateless, lists are still a pointer
+  static_assert (sizeof (list<int>) == sizeof (void*), "");
+
+  {
+    list<int> l = iota (1000);
+    ASSERT_EQ (get<cons_t<int>>(get<cons_t<int>>(l).tl).hd, 1);
+    ASSERT_EQ (stats::stats ().live, 1000u);
+    ASSERT_EQ (stats::stats ().slabs, 4u);
+    ASSERT_EQ (stats::stats ().hits, 0u);
+
+    //Consecutive nodes are neighbours in a slab
+    char const* p = reinterpret_cast<char const*>(&get<cons_t<int>>(l));
+    char const* q = reinterpret_cast<char const*>(
+      &get<cons_t<int>>(get<cons_t<int>>(l).tl));
+    ASSERT_LT (p > q ? p - q : q - p, 64);
+  }
+  ASSERT_EQ (stats::stats ().live, 0u);
+
+  //Freed nodes are recycled
+  {
+    list<int> l = iota (1000);
+    list<int> m = l;
+    ASSERT_EQ (m, l);
+    ASSERT_EQ (stats::stats ().live, 2000u);
+    ASSERT_EQ (stats::stats ().hits, 1000u);
+    ASSERT_EQ (stats::stats ().slabs, 8u);
+  }
+  ASSERT_DOUBLE_EQ (stats::stats ().hit_rate (), 1000.0 / 3000.0);
+}
+
+TEST (pgs, pool_allocator_threads) {
+
+  using stats = pool_allocator<cons_t<long>>;
+
+  //Nodes freed by another thread go back to the pool that allocated
+  //them...
+  {
+    list<long> l = iota (1000L);
+    std::thread ([&l]() { list<long> m = std::move (l); }).join ();
+    ASSERT_EQ (stats::stats ().live, 0u);
+  }
+  //...and are recycled there
+  {
+    list<long> l = iota (1000L);
+    ASSERT_EQ (stats::stats ().hits, 1000u);
+    ASSERT_EQ (stats::stats ().slabs, 4u);
+
+    //Threads free concurrently
+    std::vector<list<long>> ls;
+    for (int i = 0; i < 4; ++i)
+      ls.push_back (iota (1000L));
+    std::vector<std::thread> threads;
+    for (list<long>& m : ls)
+      threads.emplace_back ([&m]() { list<long> n = std::move (m); });
+    for (std::thread& t : threads)
+      t.join ();
+    ASSERT_EQ (stats::stats ().live, 1000u);
+  }
+  ASSERT_EQ (stats::stats ().live, 0u);
+
+  //A thread may exit while nodes it allocated are in use
+  list<long> l{constructor<nil_t>{}};
+  std::thread ([&l]() { l = iota (1000L); }).join ();
+  ASSERT_EQ (get<cons_t<long>>(get<cons_t<long>>(l).tl).hd, 1);
+  ASSERT_EQ (l, iota (1000L));
+  l = list<long>{constructor<nil_t>{}};
+
+  //Its pool, recovered, is taken over by the next thread
+  std::thread ([]() {
+    list<long> m = iota (1000L);
+    EXPECT_EQ (stats::stats ().live, 1000u);
+    EXPECT_EQ (stats::stats ().hits, 1000u);
+    EXPECT_EQ (stats::stats ().slabs, 4u);
+  }).join ();
+}
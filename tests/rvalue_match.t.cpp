@@ -0,0 +1,188 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //A value counting its copies
+  struct counted {
+    static int copies;
+
+    int k;
+
+    explicit counted (int k) : k {k}
+    {}
+    counted (counted const& other) : k {other.k} {
+      ++copies;
+    }
+    counted (counted&&) = default;
+    counted& operator= (counted const& other) {
+      k = other.k;
+      ++copies;
+      return *this;
+    }
+    counted& operator= (counted&&) = default;
+  };
+
+  int counted::copies = 0;
+
+  struct empty_t {};
+  struct node_t;
+
+  using tree = sum_type<empty_t, recursive_wrapper<node_t>>;
+
+  struct node_t {
+    counted data;
+    tree left_child, right_child;
+
+    node_t (counted&& data, tree&& left_child, tree&& right_child)
+      : data {std::move (data)}
+      , left_child {std::move (left_child)}
+      , right_child {std::move (right_child)}
+    {}
+  };
+
+  tree empty () {
+    return tree{constructor<empty_t>{}};
+  }
+
+  //Insert `k` in `t`, that is consumed : its nodes are moved into the
+  //result
+  tree insert (tree&& t, int k) {
+    return std::move (t).match<tree>(
+      [=](empty_t) {
+        return tree{constructor<node_t>{}, counted {k}, empty (), empty ()};
+      },
+      [=](node_t&& n) {
+        if (k < n.data.k)
+          return tree{constructor<node_t>{}, std::move (n.data)
+            , insert (std::move (n.left_child), k)
+            , std::move (n.right_child)};
+        if (n.data.k < k)
+          return tree{constructor<node_t>{}, std::move (n.data)
+            , std::move (n.left_child)
+            , insert (std::move (n.right_child), k)};
+        return tree{constructor<node_t>{}, std::move (n.data)
+          , std::move (n.left_child), std::move (n.right_child)};
+      });
+  }
+
+  int size (tree const& t) {
+    return t.match<int>(
+      [](empty_t) { return 0; },
+      [](node_t const& n) {
+        return 1 + size (n.left_child) + size (n.right_child);
+      });
+  }
+
+  using atom = sum_type<int, std::string>;
+
+  //Trees sharing their nodes
+  struct shared_node_t;
+
+  using shared_tree =
+    sum_type<empty_t, shared_recursive_wrapper<shared_node_t>>;
+
+  struct shared_node_t {
+    std::string s;
+    shared_tree left_child, right_child;
+
+    shared_node_t (std::string s, shared_tree left_child, shared_tree right_child)
+      : s {std::move (s)}
+      , left_child {std::move (left_child)}
+      , right_child {std::move (right_child)}
+    {}
+  };
+
+}//namespace<anonymous>
+
+TEST (pgs, rvalue_match) {
+
+  //The active value is passed as an rvalue...
+  atom a{constructor<std::string>{}, "abc"};
+  std::string s = std::move (a).match<std::string>(
+    [](int) { return std::string {}; },
+    [](std::string&& x) { return std::move (x); });
+  ASSERT_EQ (s, "abc");
+
+  //...that handlers of `T const&` accept as well
+  atom b{constructor<int>{}, 2};
+  ASSERT_EQ (std::move (b).match<int>(
+    [](int const& i) { return i; },
+    [](std::string const&) { return 0; }), 2);
+
+  //The procedure form
+  atom c{constructor<std::string>{}, "def"};
+  std::string t;
+  std::move (c).match(
+    [](int) {},
+    [&t](std::string&& x) { t = std::move (x); });
+  ASSERT_EQ (t, "def");
+
+  //`get`
+  static_assert (std::is_same<
+      decltype (get<std::string> (std::declval<atom> ())), std::string&&
+    >::value, "get : an rvalue sum gives an rvalue");
+  static_assert (std::is_same<
+      decltype (get<1> (std::declval<atom> ())), std::string&&
+    >::value, "get : an rvalue sum gives an rvalue");
+  atom d{constructor<std::string>{}, "ghi"};
+  std::string u = get<std::string> (std::move (d));
+  ASSERT_EQ (u, "ghi");
+  ASSERT_THROW (get<int> (atom{constructor<std::string>{}, "j"})
+    , invalid_sum_type_access);
+
+  //Several sums : those that are rvalues give rvalues
+  atom e{constructor<std::string>{}, "kl"}, f{constructor<std::string>{}, "mn"};
+  std::string v = match<std::string>(std::move (e), f,
+    [](std::string&& x, std::string const& y) { return std::move (x) + y; },
+    [](otherwise, otherwise) { return std::string {}; });
+  ASSERT_EQ (v, "klmn");
+
+  //A consuming insertion copies no node
+  tree r = empty ();
+  int const keys[] = {5, 3, 8, 1, 4, 7, 9, 3};
+  counted::copies = 0;
+  for (int k : keys)
+    r = insert (std::move (r), k);
+  ASSERT_EQ (counted::copies, 0);
+  ASSERT_EQ (size (r), 7);
+}
+
+TEST (pgs, rvalue_match_shared) {
+
+  //The node of a shared case is another owner's too : it is passed as
+  //a `T const&`, never moved from
+  static_assert (std::is_same<
+      decltype (get<shared_node_t> (std::declval<shared_tree> ()))
+    , shared_node_t const&>::value, "get : a shared case is not moved from");
+
+  shared_tree a{constructor<shared_node_t>{}
+    , std::string {"abc"}, shared_tree{constructor<empty_t>{}}
+    , shared_tree{constructor<empty_t>{}}};
+  shared_tree b = a;
+  std::string s = std::move (b).match<std::string>(
+    [](empty_t) { return std::string {}; },
+    [](shared_node_t n) { return std::move (n.s); });
+  ASSERT_EQ (s, "abc");
+  ASSERT_EQ (get<shared_node_t> (a).s, "abc");
+
+  shared_tree c = a;
+  std::string t = get<shared_node_t> (std::move (c)).s;
+  ASSERT_EQ (t, "abc");
+  ASSERT_EQ (get<shared_node_t> (a).s, "abc");
+
+  //Interned nodes (referred to by the intern table) likewise
+  static_assert (std::is_same<
+      rvalue_type_at<1, empty_t, interned<std::string>>, std::string const&
+    >::value, "an interned case is not moved from");
+  static_assert (std::is_same<
+      rvalue_type_at<1, empty_t, recursive_wrapper<std::string>>, std::string&&
+    >::value, "a boxed case is moved from");
+}
@@ -0,0 +1,156 @@
+#include <pgs/shared_recursive_wrapper.hpp> //first : the header stands alone
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  //A persistent (unbalanced) binary search tree with shared nodes
+  struct empty_t {};
+  bool operator== (empty_t const&, empty_t const&) { return true; }
+
+  struct node_t;
+
+  using tree = sum_type<empty_t, shared_recursive_wrapper<node_t>>;
+
+  struct node_t {
+    int key;
+    tree left;
+    tree right;
+
+    template <class L, class R>
+    node_t (int key, L&& left, R&& right)
+      : key {key}
+      , left {std::forward<L>(left)}
+      , right {std::forward<R>(right)}
+    {}
+  };
+
+  bool operator== (node_t const& l, node_t const& r) {
+    return l.key == r.key && l.left == r.left && l.right == r.right;
+  }
+
+  tree empty () { return tree{constructor<empty_t>{}}; }
+
+  tree insert (tree const& t, int k) {
+    return t.match<tree>(
+      [k](empty_t const&) {
+        return tree{constructor<node_t>{}, k, empty (), empty ()};
+      },
+      [&t, k](node_t const& n) {
+        if (k == n.key)
+          return t;
+        if (k < n.key)
+          return tree{constructor<node_t>{}, n.key, insert (n.left, k), n.right};
+        return tree{constructor<node_t>{}, n.key, n.left, insert (n.right, k)};
+      });
+  }
+
+  std::size_t size (tree const& t) {
+    return t.match<std::size_t>(
+      [](empty_t const&) { return std::size_t{0}; },
+      [](node_t const& n) { return 1 + size (n.left) + size (n.right); });
+  }
+
+  //A shared case alongside a case with data (the storage is a
+  //`recursive_union<>`)
+  struct leaf_t { int data; };
+  bool operator== (leaf_t const& l, leaf_t const& r) {
+    return l.data == r.data;
+  }
+  struct pair_t;
+  using expr = sum_type<leaf_t, shared_recursive_wrapper<pair_t>>;
+  struct pair_t {
+    expr fst, snd;
+  };
+  bool operator== (pair_t const& l, pair_t const& r) {
+    return l.fst == r.fst && l.snd == r.snd;
+  }
+
+}//namespace<anonymous>
+
+TEST (pgs, shared_recursive_wrapper) {
+
+  //Copies share the node
+  shared_recursive_wrapper<leaf_t> w{leaf_t{1}};
+  shared_recursive_wrapper<leaf_t> v = w;
+  ASSERT_EQ (w.get_pointer (), v.get_pointer ());
+  ASSERT_EQ (w.use_count (), 2u);
+  //Assigning a value doesn't affect other copies
+  v = leaf_t{2};
+  ASSERT_EQ (w.get ().data, 1);
+  ASSERT_EQ (v.get ().data, 2);
+  ASSERT_EQ (w.use_count (), 1u);
+  //Moving hands the node over
+  leaf_t const* p = w.get_pointer ();
+  shared_recursive_wrapper<leaf_t> u = std::move (w);
+  ASSERT_EQ (u.get_pointer (), p);
+  ASSERT_EQ (u.use_count (), 1u);
+}
+
+TEST (pgs, shared_recursive_wrapper_plain_count) {
+
+  using wrapper = shared_recursive_wrapper<leaf_t, plain_count>;
+  static_assert (
+    std::is_same<wrapper::count_policy, plain_count>::value, "");
+
+  wrapper w{leaf_t{1}};
+  {
+    wrapper v = w;
+    ASSERT_EQ (w.use_count (), 2u);
+    ASSERT_TRUE (v == w);
+  }
+  ASSERT_EQ (w.use_count (), 1u);
+
+  using plain_list =
+    sum_type<shared_recursive_wrapper<pair_t, plain_count>, empty_t>;
+  static_assert (sizeof (plain_list) == sizeof (void*), "");
+}
+
+TEST (pgs, shared_recursive_wrapper_tree) {
+
+  static_assert (sizeof (tree) == sizeof (void*), "");
+
+  tree t = empty ();
+  for (int k : {4, 2, 6, 1, 3, 5, 7})
+    t = insert (t, k);
+  ASSERT_EQ (size (t), 7u);
+
+  //Inserting to the left shares the right sub-tree
+  tree s = insert (t, 0);
+  ASSERT_EQ (size (s), 8u);
+  ASSERT_EQ (size (t), 7u);
+  ASSERT_EQ (
+    &get<node_t>(get<node_t>(s).right), &get<node_t>(get<node_t>(t).right));
+  ASSERT_NE (
+    &get<node_t>(get<node_t>(s).left), &get<node_t>(get<node_t>(t).left));
+
+  //Copies share, compare equal
+  tree c = t;
+  ASSERT_EQ (&get<node_t>(c), &get<node_t>(t));
+  ASSERT_EQ (c, t);
+  ASSERT_NE (s, t);
+
+  //Moves hand over
+  tree m = std::move (c);
+  ASSERT_EQ (&get<node_t>(m), &get<node_t>(t));
+}
+
+TEST (pgs, shared_recursive_wrapper_union) {
+
+  expr l{constructor<leaf_t>{}, leaf_t{1}};
+  expr p{constructor<pair_t>{}, pair_t{l, l}};
+  expr q = p;
+  ASSERT_EQ (&get<pair_t>(q), &get<pair_t>(p));
+  ASSERT_EQ (q, p);
+  ASSERT_EQ (
+    q.match<int>(
+      [](leaf_t const& x) { return x.data; },
+      [](pair_t const& x) { return get<leaf_t>(x.snd).data; }), 1);
+  q = l;
+  ASSERT_TRUE (q.is<leaf_t>());
+}
@@ -0,0 +1,98 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <utility>
+
+namespace {
+
+  using namespace pgs;
+
+  template <class T> struct cons_t;
+  template <class T> struct nil_t {};
+
+  template <class T>
+  bool operator== (nil_t<T> const&, nil_t<T> const&) { return true; }
+
+  template <class T>
+  using list = sum_type <recursive_wrapper<cons_t<T>>, nil_t<T>>;
+
+  template <class T>
+  struct cons_t {
+    T hd;
+    list<T> tl;
+
+    template <class U, class V>
+    cons_t (U&& hd, V&& tl) :
+      hd {std::forward<U> (hd)}, tl {std::forward<V>(tl)} {
+    }
+  };
+
+  template <class T>
+  bool operator== (cons_t<T> const& l, cons_t<T> const& r) {
+    return l.hd == r.hd && l.tl == r.tl;
+  }
+
+  template <class T>
+  inline list<T> nil () {
+    return list<T>{constructor<nil_t<T>>{}};
+  }
+
+  template <class U, class V>
+  inline list<decay_t<U>> cons (U&& hd, V&& tl) {
+    using T = decay_t<U>;
+    return list<T> {constructor<cons_t<T>>{}, std::forward<U> (hd), std::forward<V> (tl) };
+  }
+
+  template <class T>
+  T sum (list<T> const& l) {
+    return l.template match<T>(
+      [](cons_t<T> const& c) { return c.hd + sum (c.tl); },
+      [](nil_t<T> const&) { return T{0}; }
+    );
+  }
+
+  //A case that carries data can't be tagged
+  struct leaf_t { int data; };
+
+}//namespace<anonymous>
+
+TEST (pgs, tagged_pointer_union) {
+
+  using layout = sum_type_layout<recursive_wrapper<cons_t<int>>, nil_t<int>>;
+
+  //A list is a pointer
+  static_assert (layout::index_in_storage, "");
+  static_assert (!layout::index_in_padding, "");
+  static_assert (sizeof (list<int>) == sizeof (void*), "");
+  static_assert (layout::size == sizeof (void*), "");
+  static_assert (
+    !is_tagged_pointer_representable<
+       recursive_wrapper<cons_t<int>>, leaf_t>::value, "");
+  static_assert (!is_tagged_pointer_representable<nil_t<int>>::value, "");
+
+  list<int> l = cons (1, cons (2, cons (3, nil<int> ())));
+  ASSERT_EQ (sum (l), 6);
+  ASSERT_TRUE (l.is<cons_t<int>>());
+  ASSERT_EQ (get<cons_t<int>>(l).hd, 1);
+  ASSERT_THROW (get<nil_t<int>>(l), invalid_sum_type_access);
+  ASSERT_TRUE (get<nil_t<int>>(nil<int> ()) == nil_t<int>{});
+
+  //copy, compare
+  list<int> m = l;
+  ASSERT_EQ (m, l);
+  ASSERT_NE (&get<cons_t<int>>(m), &get<cons_t<int>>(l));
+  ASSERT_NE (m, cons (1, nil<int> ()));
+
+  //move (the allocation changes hands), assign
+  cons_t<int> const* p = &get<cons_t<int>>(m);
+  list<int> n = std::move (m);
+  ASSERT_EQ (&get<cons_t<int>>(n), p);
+  ASSERT_EQ (n, l);
+  m = nil<int> ();
+  ASSERT_TRUE (m.is<nil_t<int>>());
+  m = l;
+  ASSERT_EQ (m, l);
+  n = std::move (m);
+  ASSERT_EQ (sum (n), 6);
+}
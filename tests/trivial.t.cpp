@@ -0,0 +1,122 @@
+#include <pgs/pgs.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+  using namespace pgs;
+
+  struct nil_t {};
+
+  //The largest case (9 bytes) is smaller than the storage (16 bytes) :
+  //the index goes into the padding
+  struct bytes_t {
+    char data[9];
+    explicit bytes_t (char c) { for (char& d : data) d = c; }
+  };
+
+  //A case whose copy is user-provided (its destruction is trivial)
+  struct counted_t {
+    int i;
+    explicit counted_t (int i) : i {i}
+    {}
+    counted_t (counted_t const& c) : i {c.i}
+    {}
+    counted_t& operator= (counted_t const&) = default;
+  };
+
+  //A case that cannot be assigned
+  struct fixed_t {
+    int const i;
+  };
+
+  struct cons_t;
+  using list = sum_type<recursive_wrapper<cons_t>, nil_t>;
+  struct cons_t {
+    int hd;
+    list tl;
+  };
+
+  using token = sum_type<int, double, char>;
+  using packed = sum_type<bytes_t, std::int64_t>;
+  using counted = sum_type<int, counted_t>;
+  using fixed = sum_type<int, fixed_t>;
+  using atom = sum_type<int, std::string, nil_t>;
+
+  template <class T>
+  struct is_trivial_sum
+    : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value
+     && std::is_trivially_copy_constructible<T>::value
+     && std::is_trivially_move_constructible<T>::value
+     && std::is_trivially_copy_assignable<T>::value
+     && std::is_trivially_move_assignable<T>::value
+     && std::is_trivially_destructible<T>::value>
+  {};
+
+}//namespace<anonymous>
+
+namespace pgs {
+
+  //Flat tokens
+  template <>
+  struct sum_type_storage<int, double, nil_t> {
+    using type = flat_union<int, double, nil_t>;
+  };
+
+}//namespace pgs
+
+TEST (pgs, trivial) {
+
+  //Sums of trivial cases are trivial...
+  static_assert (is_trivial_sum<token>::value, "");
+  static_assert (is_trivial_sum<packed>::value, "");
+  static_assert (is_trivial_sum<sum_type<int, double, nil_t>>::value, "");
+  static_assert (is_trivial_sum<sum_type<nil_t, bool>>::value, "");
+  static_assert (std::is_trivially_copyable<recursive_union<int, char>>::value
+               , "");
+
+  //...sums of a case that isn't, aren't
+  static_assert (std::is_trivially_destructible<counted>::value, "");
+  static_assert (!std::is_trivially_copy_constructible<counted>::value, "");
+  static_assert (!std::is_trivially_copyable<counted>::value, "");
+  static_assert (std::is_trivially_destructible<fixed>::value, "");
+  static_assert (!std::is_trivially_copyable<fixed>::value, "");
+  static_assert (std::is_copy_assignable<fixed>::value, "");
+  static_assert (!std::is_trivially_destructible<atom>::value, "");
+  static_assert (!std::is_trivially_copyable<atom>::value, "");
+  static_assert (std::is_nothrow_move_constructible<atom>::value, "");
+  static_assert (!std::is_trivially_destructible<list>::value, "");
+  static_assert (!std::is_trivially_copyable<list>::value, "");
+
+  //A trivial sum may be copied by `std::memcpy`
+  token t{constructor<double>{}, 1.5};
+  token u{constructor<char>{}, 'x'};
+  std::memcpy (&u, &t, sizeof (token));
+  ASSERT_TRUE (u.is<double>());
+  ASSERT_EQ (get<double>(u), 1.5);
+
+  //The index in the padding is copied
+  packed p{constructor<bytes_t>{}, 'p'};
+  packed q{constructor<std::int64_t>{}, 1};
+  q = p;
+  ASSERT_TRUE (q.is_type_at<0>());
+  ASSERT_EQ (get<0>(q).data[8], 'p');
+  packed r (q);
+  ASSERT_TRUE (r.is_type_at<0>());
+
+  //Sums that are not trivially copyable are copied case-wise
+  counted c{constructor<counted_t>{}, 2};
+  counted d{constructor<int>{}, 3};
+  d = c;
+  ASSERT_EQ (get<counted_t>(d).i, 2);
+  fixed f{constructor<fixed_t>{}, fixed_t{4}};
+  fixed g{constructor<fixed_t>{}, fixed_t{5}};
+  f = g;
+  ASSERT_EQ (get<fixed_t>(f).i, 5);
+}